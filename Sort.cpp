@@ -3,6 +3,27 @@
 #include <functional> // for std::less
 #include <iostream>
 #include <algorithm>
+#include <iterator>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "SortingNetwork.h"
+
+#if defined(SORT_STATS)
+#include "priorityQueue_and_pairingHeap/Instrument.h"
+#include <cassert>
+#include <cstdlib>
+#endif
 
 using namespace std;
 
@@ -43,6 +64,8 @@ void selectionSort(vector<T> & target){
 
 template<typename InputIterator, typename COMP_FUNCTOR>
 void insertionSort(InputIterator begin, InputIterator end, COMP_FUNCTOR comp){
+    // zero or one element is sorted
+    if(end - begin < 2) return;
     // first swap the smallest element to the first 
     
     for(InputIterator i = end - 1; i != begin; --i){
@@ -51,72 +74,1257 @@ void insertionSort(InputIterator begin, InputIterator end, COMP_FUNCTOR comp){
     // now the first two element are sorted
     for(InputIterator i = begin + 2; i != end; ++i){
         // this is the element needed to insert to the already sorted arr
-        auto currElement = *i;
+        auto currElement = std::move(*i);
         InputIterator j = i;
         while(comp(currElement, *(j - 1))){
-            *j = *(j - 1);
+            *j = std::move(*(j - 1));
             --j;
         }
         // j will stop at the location where currElement should be
-        *j = currElement;
+        *j = std::move(currElement);
     }
 }
 
+// REQUIRE: index < end - begin
+// MODIFY: move the element at index down the max-heap in [begin, end) until
+//         it is not smaller than its children
 template<typename InputIterator, typename COMP_FUNCTOR>
-void quickSort(InputIterator begin, InputIterator end, COMP_FUNCTOR comp){
-    // base case
-    if(begin + 1 >= end) return;
+void siftDown(InputIterator begin, InputIterator end, size_t index, COMP_FUNCTOR comp){
+    size_t size = end - begin;
+    auto moving = std::move(begin[index]);
+    while(2 * index + 1 < size){
+        size_t child = 2 * index + 1;
+        if(child + 1 < size && comp(begin[child], begin[child + 1])) ++child;
+        if(!comp(moving, begin[child])) break;
+        begin[index] = std::move(begin[child]);
+        index = child;
+    }
+    begin[index] = std::move(moving);
+}
 
-    // start partition
-    InputIterator pivot = end - 1;
-    InputIterator left = begin;
-    InputIterator right = end - 2;
-    
-    while(true){
-        // move left until left >= pivot, that is swap candidate
-        while(comp(*left, *pivot)) ++left;
+// O(n log(n)) in every case and sorts in place, but it jumps around in
+// memory, so it is slower than quickSort on average
+template<typename InputIterator, typename COMP_FUNCTOR>
+void heapSort(InputIterator begin, InputIterator end, COMP_FUNCTOR comp){
+    size_t size = end - begin;
+    if(size < 2) return;
+    // build a max-heap bottom-up, then move the max to the back one by one
+    for(size_t i = size / 2; i > 0; --i) siftDown(begin, end, i - 1, comp);
+    for(InputIterator last = end - 1; last != begin; --last){
+        swap(*begin, *last);
+        siftDown(begin, last, 0, comp);
+    }
+}
 
-        // move right until left >= right or right < pivot
-        while(left < right && comp(*pivot, *right)) --right;
+// EFFECT: return the one of a, b and c that holds the median value
+template<typename InputIterator, typename COMP_FUNCTOR>
+InputIterator medianOf3(InputIterator a, InputIterator b, InputIterator c, COMP_FUNCTOR comp){
+    if(comp(*a, *b)){
+        if(comp(*b, *c)) return b;
+        return comp(*a, *c) ? c : a;
+    }
+    if(comp(*a, *c)) return a;
+    return comp(*b, *c) ? c : b;
+}
 
-        if(left >= right) break;
+// REQUIRE: end - begin >= 3
+// EFFECT: return the pivot for partitioning: the median of the first, middle
+//         and last element, or for large ranges Tukey's ninther, the median
+//         of three such medians taken over the whole range. Both are never
+//         the extreme of a sorted or reversed range
+template<typename InputIterator, typename COMP_FUNCTOR>
+InputIterator choosePivot(InputIterator begin, InputIterator end, COMP_FUNCTOR comp){
+    const ptrdiff_t NINTHER_SIZE = 128;
+    ptrdiff_t size = end - begin;
+    InputIterator mid = begin + size / 2;
+    InputIterator last = end - 1;
+    if(size < NINTHER_SIZE) return medianOf3(begin, mid, last, comp);
+    ptrdiff_t step = size / 8;
+    return medianOf3(medianOf3(begin, begin + step, begin + 2 * step, comp),
+                     medianOf3(mid - step, mid, mid + step, comp),
+                     medianOf3(last - 2 * step, last - step, last, comp), comp);
+}
 
+// REQUIRE: the pivot is at begin
+// MODIFY: move the elements not larger than the pivot to its left and the
+//         ones not smaller to its right. Both scans stop at elements equal to
+//         the pivot and swap them, so many equal keys split evenly
+// EFFECT: return where the pivot ends up
+template<typename InputIterator, typename COMP_FUNCTOR>
+InputIterator hoarePartition(InputIterator begin, InputIterator end, COMP_FUNCTOR comp){
+    InputIterator left = begin + 1;
+    InputIterator right = end - 1;
+    while(true){
+        while(left <= right && comp(*left, *begin)) ++left;
+        while(left <= right && comp(*begin, *right)) --right;
+        if(left >= right) break;
         swap(*left, *right);
+        ++left;
+        --right;
+    }
+    // right is at the last element that is not larger than the pivot
+    swap(*begin, *right);
+    return right;
+}
+
+// the size of the ranges that quickSort leaves to a sorting network, and of
+// the runs that mergeSort makes with one
+const ptrdiff_t NETWORK_QUICK_SIZE = 64;
+const ptrdiff_t NETWORK_RUN_SIZE = 64;
+
+// MODIFY: sort [begin, end) by partitioning until ranges are small enough for
+//         insertion sort, or switch to heapSort when depthLimit partitions in
+//         a row did not shrink the range enough
+template<typename InputIterator, typename COMP_FUNCTOR>
+void introSortLoop(InputIterator begin, InputIterator end, size_t depthLimit, COMP_FUNCTOR comp){
+    using Network = SortingNetworkFor<InputIterator, COMP_FUNCTOR>;
+    // a sorting network finishes larger ranges than insertion sort can
+    const ptrdiff_t SMALL_SIZE = Network::ENABLED ? NETWORK_QUICK_SIZE : 16;
+    while(end - begin > SMALL_SIZE){
+        if(depthLimit == 0){
+            heapSort(begin, end, comp);
+            return;
+        }
+        --depthLimit;
+        swap(*begin, *choosePivot(begin, end, comp));
+        InputIterator cut = hoarePartition(begin, end, comp);
+        // recurse into the smaller side and loop on the larger one, so the
+        // stack never holds more than log(n) frames
+        if(cut - begin < end - cut){
+            introSortLoop(begin, cut, depthLimit, comp);
+            begin = cut + 1;
+        }
+        else{
+            introSortLoop(cut + 1, end, depthLimit, comp);
+            end = cut;
+        }
+    }
+    if(!Network::sort(begin, end)) insertionSort(begin, end, comp);
+}
+
+// An introsort: quicksort with a median-of-3 or ninther pivot, insertion sort
+// for ranges of up to 16 elements, and heapSort for ranges that are still
+// partitioned 2 * log(n) levels deep, so it is O(n log(n)) on every input.
+// Arrays of int, long, float and double compared with std::less or
+// std::greater are partitioned down to 64 elements and finished by a
+// SortingNetwork instead
+template<typename InputIterator, typename COMP_FUNCTOR>
+void quickSort(InputIterator begin, InputIterator end, COMP_FUNCTOR comp){
+    size_t depthLimit = 0;
+    for(ptrdiff_t size = end - begin; size > 1; size /= 2) depthLimit += 2;
+    introSortLoop(begin, end, depthLimit, comp);
+}
+
+// EFFECT: return the first element of the sorted range [first, last) that is
+//         not smaller than value, found by checking positions 1, 2, 4, ...
+//         first and then searching binary between the last two, so a short
+//         answer costs few comparisons
+template<typename InputIterator, typename T, typename COMP_FUNCTOR>
+InputIterator gallopLower(InputIterator first, InputIterator last, const T& value, COMP_FUNCTOR comp){
+    ptrdiff_t size = last - first;
+    ptrdiff_t low = 0;
+    ptrdiff_t step = 1;
+    while(step <= size && comp(first[step - 1], value)){
+        low = step;
+        step *= 2;
+    }
+    return lower_bound(first + low, first + min(step, size), value, comp);
+}
+
+// EFFECT: return the first element of the sorted range [first, last) that is
+//         larger than value, searched like gallopLower()
+template<typename InputIterator, typename T, typename COMP_FUNCTOR>
+InputIterator gallopUpper(InputIterator first, InputIterator last, const T& value, COMP_FUNCTOR comp){
+    ptrdiff_t size = last - first;
+    ptrdiff_t low = 0;
+    ptrdiff_t step = 1;
+    while(step <= size && !comp(value, first[step - 1])){
+        low = step;
+        step *= 2;
+    }
+    return upper_bound(first + low, first + min(step, size), value, comp);
+}
+
+// REQUIRE: [first1, last1) and [first2, last2) are sorted
+// MODIFY: move both ranges, merged, to out, elements of the first range go
+//         first among equal ones. When one range wins 7 times in a row, the
+//         merge gallops: it finds how far that range keeps winning with
+//         gallopLower() or gallopUpper() and moves the whole block at once,
+//         so merging runs that barely overlap takes few comparisons
+// EFFECT: return out after the last moved element
+template<typename InputIterator, typename OutputIterator, typename COMP_FUNCTOR>
+OutputIterator mergeRuns(InputIterator first1, InputIterator last1, InputIterator first2,
+                         InputIterator last2, OutputIterator out, COMP_FUNCTOR comp){
+    const int GALLOP_START = 7;
+    int wins1 = 0;
+    int wins2 = 0;
+    while(first1 != last1 && first2 != last2){
+        if(comp(*first2, *first1)){
+            *out = std::move(*first2);
+            ++out;
+            ++first2;
+            wins1 = 0;
+            if(++wins2 >= GALLOP_START && first2 != last2){
+                InputIterator blockEnd = gallopLower(first2, last2, *first1, comp);
+                out = std::move(first2, blockEnd, out);
+                first2 = blockEnd;
+                wins2 = 0;
+            }
+        }
+        else{
+            *out = std::move(*first1);
+            ++out;
+            ++first1;
+            wins2 = 0;
+            if(++wins1 >= GALLOP_START && first1 != last1){
+                InputIterator blockEnd = gallopUpper(first1, last1, *first2, comp);
+                out = std::move(first1, blockEnd, out);
+                first1 = blockEnd;
+                wins1 = 0;
+            }
+        }
+    }
+    out = std::move(first1, last1, out);
+    return std::move(first2, last2, out);
+}
+
+// REQUIRE: runs holds the start of every sorted run of src, then its size
+// MODIFY: merge runs 0 and 1, 2 and 3, ... of src into dst, an unpaired last
+//         run is moved over as it is, and update runs to the merged runs
+template<typename InputIterator, typename OutputIterator, typename COMP_FUNCTOR>
+void mergePass(InputIterator src, vector<ptrdiff_t>& runs, OutputIterator dst, COMP_FUNCTOR comp){
+    size_t merged = 0;
+    size_t run = 0;
+    for(; run + 2 < runs.size(); run += 2){
+        dst = mergeRuns(src + runs[run], src + runs[run + 1], src + runs[run + 1],
+                        src + runs[run + 2], dst, comp);
+        runs[merged++] = runs[run];
+    }
+    if(run + 1 < runs.size()){
+        dst = std::move(src + runs[run], src + runs[run + 1], dst);
+        runs[merged++] = runs[run];
+    }
+    runs[merged++] = runs.back();
+    runs.resize(merged);
+}
+
+// REQUIRE: [begin, sortedEnd) is sorted
+// MODIFY: insert the elements of [sortedEnd, end) one by one into the sorted
+//         part, after the equal ones, finding each place by binary search.
+//         That takes O(log(n)) comparisons per element, fewer than
+//         insertionSort's linear scan
+template<typename InputIterator, typename COMP_FUNCTOR>
+void binaryInsertionSort(InputIterator begin, InputIterator sortedEnd, InputIterator end, COMP_FUNCTOR comp){
+    for(InputIterator i = sortedEnd; i != end; ++i){
+        InputIterator place = upper_bound(begin, i, *i, comp);
+        if(place == i) continue;
+        auto currElement = std::move(*i);
+        move_backward(place, i, i + 1);
+        *place = std::move(currElement);
+    }
+}
+
+// REQUIRE: end - begin >= 2
+// MODIFY: split [begin, end) into the runs it already has: ascending ones,
+//         and strictly descending ones that are reversed. Runs shorter than
+//         32 elements are extended with binary insertion sort, or to 64
+//         elements with a SortingNetwork for the types it sorts, where equal
+//         elements are indistinguishable
+// EFFECT: return the start of every run, then the size of the range
+template<typename InputIterator, typename COMP_FUNCTOR>
+vector<ptrdiff_t> findRuns(InputIterator begin, InputIterator end, COMP_FUNCTOR comp){
+    using Network = SortingNetworkFor<InputIterator, COMP_FUNCTOR>;
+    // a network sorts longer runs as fast as binary insertion sorts short ones
+    const ptrdiff_t MIN_RUN = Network::ENABLED ? NETWORK_RUN_SIZE : 32;
+    ptrdiff_t size = end - begin;
+    vector<ptrdiff_t> runs;
+    for(ptrdiff_t start = 0; start < size;){
+        ptrdiff_t stop = start + 1;
+        if(stop < size && comp(begin[stop], begin[start])){
+            while(stop < size && comp(begin[stop], begin[stop - 1])) ++stop;
+            reverse(begin + start, begin + stop);
+        }
+        else{
+            while(stop < size && !comp(begin[stop], begin[stop - 1])) ++stop;
+        }
+        if(stop - start < MIN_RUN){
+            ptrdiff_t sortedStop = stop;
+            stop = min(start + MIN_RUN, size);
+            if(!Network::sort(begin + start, begin + stop)){
+                binaryInsertionSort(begin + start, begin + sortedStop, begin + stop, comp);
+            }
+        }
+        runs.push_back(start);
+        start = stop;
+    }
+    runs.push_back(size);
+    return runs;
+}
+
+// EFFECT: return how many passes merge the runs found by findRuns() into one.
+//         They alternate between the range and a buffer, if it is odd the
+//         first pass reads from the buffer, so that the last one writes into
+//         the range
+inline size_t mergePassCount(const vector<ptrdiff_t>& runs){
+    size_t passes = 0;
+    for(size_t count = runs.size() - 1; count > 1; count = (count + 1) / 2) ++passes;
+    return passes;
+}
+
+// REQUIRE: the runs are in buffer, and the passes left to merge them are odd
+// MODIFY: merge the runs pass by pass between buffer and begin, until they
+//         are one run at begin
+template<typename InputIterator, typename BufferIterator, typename COMP_FUNCTOR>
+void finishMergePasses(InputIterator begin, BufferIterator buffer, vector<ptrdiff_t>& runs, COMP_FUNCTOR comp){
+    bool inBuffer = true;
+    while(runs.size() > 2){
+        if(inBuffer) mergePass(buffer, runs, begin, comp);
+        else mergePass(begin, runs, buffer, comp);
+        inBuffer = !inBuffer;
     }
-    // after that, left will stay at the pivot or element larger than pivot
-    swap(*left, *pivot);
-    quickSort(begin, left, comp);
-    quickSort(left + 1, end, comp);
 }
 
+// mergeSort() with the scratch space passed in instead of allocated: buffer
+// must have room for end - begin elements, which it overwrites
+template<typename InputIterator, typename BufferIterator, typename COMP_FUNCTOR>
+void mergeSortWith(InputIterator begin, InputIterator end, BufferIterator buffer, COMP_FUNCTOR comp){
+    if(end - begin < 2) return;
+    vector<ptrdiff_t> runs = findRuns(begin, end, comp);
+    if(runs.size() == 2) return;
+    if(mergePassCount(runs) % 2 == 1) std::move(begin, end, buffer);
+    else mergePass(begin, runs, buffer, comp);
+    finishMergePasses(begin, buffer, runs, comp);
+}
+
+// A stable, natural, bottom-up merge sort. The range is first split into
+// the runs it already has by findRuns(). Then each pass merges neighbouring
+// runs, moving the elements between the range and one buffer of n elements,
+// so nearly sorted data takes few passes, and the merges gallop through runs
+// that barely overlap
 template<typename InputIterator, typename COMP_FUNCTOR>
 void mergeSort(InputIterator begin, InputIterator end, COMP_FUNCTOR comp){
-    // base case, one or zero element
-    if(begin + 1 >= end) return;
-    
-    // partition, left is always smaller than or equal to right
-    InputIterator mid = begin + (end - begin) / 2;
-    InputIterator left = begin;
-    InputIterator right = mid;
-    mergeSort(begin, mid, comp);
-    mergeSort(mid, end, comp);
-
-    // merge
-    vector<decltype(*begin + 0)> temp(end - begin);
-    for(auto it = temp.begin(); it != temp.end();){
-        // if left is done
-        if(left == mid) *(it++) = *(right++);
-        // if right is done
-        else if(right == end) *(it++) = *(left++);
+    using T = typename iterator_traits<InputIterator>::value_type;
+    if(end - begin < 2) return;
+    vector<ptrdiff_t> runs = findRuns(begin, end, comp);
+    if(runs.size() == 2) return;
+
+    // the buffer is filled by the first pass, or by moving the range over
+    vector<T> buffer;
+    buffer.reserve(static_cast<size_t>(end - begin));
+    if(mergePassCount(runs) % 2 == 1){
+        buffer.assign(make_move_iterator(begin), make_move_iterator(end));
+    }
+    else{
+        mergePass(begin, runs, back_inserter(buffer), comp);
+    }
+    finishMergePasses(begin, buffer.begin(), runs, comp);
+}
+
+// A pool of threads for fork-join parallelism. invoke(first, second) offers
+// second to the other threads and runs first itself. Every thread has its own
+// deque of offered tasks: it takes new work from the back of its own deque,
+// and an idle thread steals from the front of another one, where the oldest
+// and so the largest pieces of a recursive split are. A thread that waits for
+// a task to finish runs other tasks meanwhile, so nested invoke() calls never
+// block a thread.
+class WorkStealingPool {
+public:
+    // Description: Start a pool of threads threads, including the thread that
+    //              calls invoke(). 0 means one per core.
+    explicit WorkStealingPool(size_t threads = 0) : stopping{ false } {
+        if(threads == 0) threads = max(1u, thread::hardware_concurrency());
+        // one deque per worker, and the last one for threads outside the pool
+        for(size_t i = 0; i < threads; ++i) this->deques.emplace_back(new Deque);
+        for(size_t i = 0; i + 1 < threads; ++i){
+            this->workers.emplace_back([this, i](){ this->work(i); });
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    ~WorkStealingPool(){
+        this->stopping.store(true);
+        for(thread& worker : this->workers) worker.join();
+    }
+
+    // Description: Run first and second, possibly at the same time, and return
+    //              when both are done.
+    // REQUIRE: first and second do not throw
+    template<typename FIRST, typename SECOND>
+    void invoke(FIRST&& first, SECOND&& second){
+        Task task(std::forward<SECOND>(second));
+        Deque& own = *this->deques[this->ownIndex()];
+        {
+            lock_guard<mutex> guard(own.lock);
+            own.tasks.push_back(&task);
+        }
+        first();
+        while(!task.done.load(memory_order_acquire)){
+            if(!this->runOne()) this_thread::yield();
+        }
+    }
+
+private:
+    struct Task {
+        function<void()> run;
+        atomic<bool> done;
+
+        template<typename F>
+        explicit Task(F&& f) : run(std::forward<F>(f)), done{ false } {}
+    };
+
+    struct Deque {
+        mutex lock;
+        deque<Task*> tasks;
+    };
+
+    vector<unique_ptr<Deque>> deques;
+    vector<thread> workers;
+    atomic<bool> stopping;
+
+    // EFFECT: return the pool and worker index of this thread
+    static pair<const WorkStealingPool*, size_t>& current(){
+        static thread_local pair<const WorkStealingPool*, size_t> worker(nullptr, 0);
+        return worker;
+    }
+
+    // EFFECT: return the deque this thread offers its tasks on, threads
+    //         outside the pool share the last one
+    size_t ownIndex() const {
+        const pair<const WorkStealingPool*, size_t>& worker = current();
+        return (worker.first == this) ? worker.second : this->deques.size() - 1;
+    }
+
+    // MODIFY: run the newest task of this thread's deque, or steal the
+    //         oldest task of another deque
+    // EFFECT: return false if there was no task anywhere
+    bool runOne(){
+        size_t own = this->ownIndex();
+        Task* task = nullptr;
+        {
+            Deque& mine = *this->deques[own];
+            lock_guard<mutex> guard(mine.lock);
+            if(!mine.tasks.empty()){
+                task = mine.tasks.back();
+                mine.tasks.pop_back();
+            }
+        }
+        for(size_t i = 1; task == nullptr && i < this->deques.size(); ++i){
+            Deque& victim = *this->deques[(own + i) % this->deques.size()];
+            lock_guard<mutex> guard(victim.lock);
+            if(!victim.tasks.empty()){
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+            }
+        }
+        if(task == nullptr) return false;
+        task->run();
+        task->done.store(true, memory_order_release);
+        return true;
+    }
+
+    void work(size_t index){
+        current() = make_pair(this, index);
+        size_t idle = 0;
+        while(!this->stopping.load()){
+            if(this->runOne()) idle = 0;
+            // back off from spinning when there has been nothing to do for a while
+            else if(++idle < 64) this_thread::yield();
+            else this_thread::sleep_for(chrono::microseconds(100));
+        }
+    }
+}; // WorkStealingPool
+
+// REQUIRE: [first1, last1) and [first2, last2) are sorted
+// MODIFY: move both ranges, merged like mergeRuns(), to out. Large merges are
+//         split in two independent ones: the middle element of the longer
+//         range is found in the other range by binary search, everything
+//         before it is merged by one task and everything after it by another.
+//         A cutoff below 2 is taken as 2, a merge of two single elements
+//         can not be split
+template<typename InputIterator, typename OutputIterator, typename COMP_FUNCTOR>
+void parallelMerge(InputIterator first1, InputIterator last1, InputIterator first2,
+                   InputIterator last2, OutputIterator out, COMP_FUNCTOR comp,
+                   WorkStealingPool& pool, ptrdiff_t cutoff){
+    cutoff = max(cutoff, ptrdiff_t(2));
+    ptrdiff_t size1 = last1 - first1;
+    ptrdiff_t size2 = last2 - first2;
+    if(size1 + size2 <= cutoff){
+        mergeRuns(first1, last1, first2, last2, out, comp);
+        return;
+    }
+    InputIterator split1;
+    InputIterator split2;
+    // equal elements of the first range stay in front of the second's
+    if(size1 >= size2){
+        split1 = first1 + size1 / 2;
+        split2 = lower_bound(first2, last2, *split1, comp);
+    }
+    else{
+        split2 = first2 + size2 / 2;
+        split1 = upper_bound(first1, last1, *split2, comp);
+    }
+    OutputIterator outSplit = out + (split1 - first1) + (split2 - first2);
+    pool.invoke([&](){ parallelMerge(first1, split1, first2, split2, out, comp, pool, cutoff); },
+                [&](){ parallelMerge(split1, last1, split2, last2, outSplit, comp, pool, cutoff); });
+}
+
+// REQUIRE: cutoff >= 2
+// MODIFY: sort [begin, end) and move the result to out, using the range
+//         itself as scratch space
+template<typename InputIterator, typename OutputIterator, typename COMP_FUNCTOR>
+void parallelMergeSortInto(InputIterator begin, InputIterator end, OutputIterator out,
+                           COMP_FUNCTOR comp, WorkStealingPool& pool, ptrdiff_t cutoff);
+
+// REQUIRE: cutoff >= 2
+// MODIFY: sort [begin, end) in place, using buffer, which has room for as
+//         many elements, as scratch space. Each half is sorted into the
+//         buffer by its own task, then the halves are merged back
+template<typename InputIterator, typename OutputIterator, typename COMP_FUNCTOR>
+void parallelMergeSortInPlace(InputIterator begin, InputIterator end, OutputIterator buffer,
+                              COMP_FUNCTOR comp, WorkStealingPool& pool, ptrdiff_t cutoff){
+    ptrdiff_t size = end - begin;
+    if(size <= cutoff){
+        mergeSortWith(begin, end, buffer, comp);
+        return;
+    }
+    InputIterator mid = begin + size / 2;
+    OutputIterator bufferMid = buffer + size / 2;
+    pool.invoke([&](){ parallelMergeSortInto(begin, mid, buffer, comp, pool, cutoff); },
+                [&](){ parallelMergeSortInto(mid, end, bufferMid, comp, pool, cutoff); });
+    parallelMerge(buffer, bufferMid, bufferMid, buffer + size, begin, comp, pool, cutoff);
+}
+
+template<typename InputIterator, typename OutputIterator, typename COMP_FUNCTOR>
+void parallelMergeSortInto(InputIterator begin, InputIterator end, OutputIterator out,
+                           COMP_FUNCTOR comp, WorkStealingPool& pool, ptrdiff_t cutoff){
+    ptrdiff_t size = end - begin;
+    if(size <= cutoff){
+        mergeSortWith(begin, end, out, comp);
+        std::move(begin, end, out);
+        return;
+    }
+    InputIterator mid = begin + size / 2;
+    OutputIterator outMid = out + size / 2;
+    pool.invoke([&](){ parallelMergeSortInPlace(begin, mid, out, comp, pool, cutoff); },
+                [&](){ parallelMergeSortInPlace(mid, end, outMid, comp, pool, cutoff); });
+    parallelMerge(begin, mid, mid, end, out, comp, pool, cutoff);
+}
+
+// A stable merge sort that sorts the two halves of every range above cutoff
+// elements as parallel tasks on pool, and merges them with parallelMerge().
+// The elements are moved into one buffer first and the levels of the
+// recursion alternate between the buffer and the range, so each level moves
+// every element once. Ranges up to cutoff elements are sorted by
+// mergeSortWith() in the part of the other one they will go to, so nothing
+// else is allocated. A cutoff below 2 is taken as 2
+// REQUIRE: comp can be called from several threads at once
+template<typename InputIterator, typename COMP_FUNCTOR>
+void parallelMergeSort(InputIterator begin, InputIterator end, COMP_FUNCTOR comp,
+                       WorkStealingPool& pool, ptrdiff_t cutoff = 8192){
+    using T = typename iterator_traits<InputIterator>::value_type;
+    cutoff = max(cutoff, ptrdiff_t(2));
+    if(end - begin <= cutoff){
+        mergeSort(begin, end, comp);
+        return;
+    }
+    vector<T> buffer(make_move_iterator(begin), make_move_iterator(end));
+    parallelMergeSortInto(buffer.begin(), buffer.end(), begin, comp, pool, cutoff);
+}
+
+// REQUIRE: cutoff >= 2
+// MODIFY: partition like introSortLoop() and sort both sides as parallel
+//         tasks, ranges up to cutoff elements are sorted by quickSort()
+template<typename InputIterator, typename COMP_FUNCTOR>
+void parallelQuickSortLoop(InputIterator begin, InputIterator end, size_t depthLimit,
+                           COMP_FUNCTOR comp, WorkStealingPool& pool, ptrdiff_t cutoff){
+    if(end - begin <= cutoff){
+        quickSort(begin, end, comp);
+        return;
+    }
+    if(depthLimit == 0){
+        heapSort(begin, end, comp);
+        return;
+    }
+    swap(*begin, *choosePivot(begin, end, comp));
+    InputIterator cut = hoarePartition(begin, end, comp);
+    pool.invoke([&](){ parallelQuickSortLoop(begin, cut, depthLimit - 1, comp, pool, cutoff); },
+                [&](){ parallelQuickSortLoop(cut + 1, end, depthLimit - 1, comp, pool, cutoff); });
+}
+
+// quickSort() with both sides of every partition above cutoff elements
+// sorted as parallel tasks on pool. The partitioning itself is sequential,
+// so the first levels limit how well it scales. A cutoff below 2 is taken
+// as 2
+// REQUIRE: comp can be called from several threads at once
+template<typename InputIterator, typename COMP_FUNCTOR>
+void parallelQuickSort(InputIterator begin, InputIterator end, COMP_FUNCTOR comp,
+                       WorkStealingPool& pool, ptrdiff_t cutoff = 8192){
+    cutoff = max(cutoff, ptrdiff_t(2));
+    size_t depthLimit = 0;
+    for(ptrdiff_t size = end - begin; size > 1; size /= 2) depthLimit += 2;
+    parallelQuickSortLoop(begin, end, depthLimit, comp, pool, cutoff);
+}
+
+// Returns the element itself, the default key of the radix sorts.
+struct IdentityKey {
+    template<typename T>
+    const T& operator()(const T& elt) const { return elt; }
+};
+
+// Returns one field of a record, to radix sort records by it:
+//     radixSort(v.begin(), v.end(), makeFieldKey(&Record::time));
+template<typename RECORD, typename FIELD>
+struct FieldKey {
+    FIELD RECORD::* field;
+
+    const FIELD& operator()(const RECORD& record) const { return record.*field; }
+};
+
+template<typename RECORD, typename FIELD>
+FieldKey<RECORD, FIELD> makeFieldKey(FIELD RECORD::* field){
+    return FieldKey<RECORD, FIELD>{ field };
+}
+
+// EFFECT: return key as an unsigned integer of the same width that has the
+//         same order as key
+template<typename KEY>
+typename enable_if<is_unsigned<KEY>::value, KEY>::type radixBits(KEY key){
+    return key;
+}
+
+// negative numbers are two's complement, flipping the sign bit puts them first
+template<typename KEY>
+typename enable_if<is_integral<KEY>::value && is_signed<KEY>::value,
+                   typename make_unsigned<KEY>::type>::type radixBits(KEY key){
+    using Bits = typename make_unsigned<KEY>::type;
+    return static_cast<Bits>(static_cast<Bits>(key) ^ (Bits(1) << (numeric_limits<Bits>::digits - 1)));
+}
+
+// IEEE floats are sign and magnitude: the sign bit is set on positive numbers
+// so they come after the negative ones, and all bits of negative numbers are
+// flipped so larger magnitudes come first. -0.0 comes right before 0.0,
+// negative NaNs before everything else and positive NaNs after everything
+inline uint32_t radixBits(float key){
+    uint32_t bits;
+    memcpy(&bits, &key, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+inline uint64_t radixBits(double key){
+    uint64_t bits;
+    memcpy(&bits, &key, sizeof(bits));
+    return (bits & 0x8000000000000000ull) ? ~bits : (bits | 0x8000000000000000ull);
+}
+
+// below this many elements the radix sorts use insertionSort()
+const ptrdiff_t RADIX_MIN_SIZE = 64;
+// ranges of more bytes than this are split by their highest byte first, so
+// the passes over the lower bytes run on buckets that fit in the cache
+const size_t RADIX_CACHE_BYTES = 1 << 19;
+
+// REQUIRE: the keys in [begin, end) agree in all bytes from digits on,
+//          scratch has room for end - begin elements
+// MODIFY: sort [begin, end) by the lower digits bytes of the keys
+template<typename InputIterator, typename KEY_FUNCTOR>
+void radixSortLoop(InputIterator begin, InputIterator end,
+                   typename iterator_traits<InputIterator>::value_type* scratch,
+                   size_t digits, KEY_FUNCTOR key){
+    using T = typename iterator_traits<InputIterator>::value_type;
+    using Bits = decltype(radixBits(key(*begin)));
+    size_t size = static_cast<size_t>(end - begin);
+    if(size < static_cast<size_t>(RADIX_MIN_SIZE)){
+        insertionSort(begin, end, [&key](const T& a, const T& b){
+            return radixBits(key(a)) < radixBits(key(b));
+        });
+        return;
+    }
+    Bits first = radixBits(key(*begin));
+    Bits differ = 0;
+    for(InputIterator it = begin; it != end; ++it) differ |= radixBits(key(*it)) ^ first;
+    if(differ == 0) return;
+    size_t top = digits - 1;
+    while(((differ >> (8 * top)) & 0xff) == 0) --top;
+    // a local array, the compiler can keep it apart from the elements
+    size_t next[256];
+
+    if(size * sizeof(T) > RADIX_CACHE_BYTES && top > 0){
+        // split by the highest byte that is not the same in all keys
+        size_t shift = 8 * top;
+        fill(next, next + 256, 0);
+        for(InputIterator it = begin; it != end; ++it) next[(radixBits(key(*it)) >> shift) & 0xff]++;
+        size_t bucketEnd[256];
+        size_t start = 0;
+        for(size_t byte = 0; byte < 256; ++byte){
+            start += next[byte];
+            bucketEnd[byte] = start;
+            next[byte] = start - next[byte];
+        }
+        for(InputIterator it = begin; it != end; ++it){
+            scratch[next[(radixBits(key(*it)) >> shift) & 0xff]++] = std::move(*it);
+        }
+        std::move(scratch, scratch + size, begin);
+        size_t bucketBegin = 0;
+        for(size_t byte = 0; byte < 256; ++byte){
+            if(bucketEnd[byte] - bucketBegin > 1){
+                radixSortLoop(begin + bucketBegin, begin + bucketEnd[byte], scratch + bucketBegin, top, key);
+            }
+            bucketBegin = bucketEnd[byte];
+        }
+        return;
+    }
+
+    // one pass counts all bytes, then one pass per byte from the lowest up
+    // moves every element into the bucket of its byte
+    // counting all bytes is a loop of constant length, which is faster than
+    // skipping the ones above top
+    const size_t DIGITS = sizeof(Bits);
+    size_t counts[DIGITS][256];
+    fill(&counts[0][0], &counts[0][0] + DIGITS * 256, 0);
+    for(InputIterator it = begin; it != end; ++it){
+        Bits bits = radixBits(key(*it));
+        for(size_t digit = 0; digit < DIGITS; ++digit){
+            counts[digit][(bits >> (8 * digit)) & 0xff]++;
+        }
+    }
+    bool inScratch = false;
+    for(size_t digit = 0; digit <= top; ++digit){
+        const size_t* count = counts[digit];
+        size_t shift = 8 * digit;
+        if(((differ >> shift) & 0xff) == 0) continue;
+        // next[byte] is where the next element of the bucket of byte goes
+        size_t start = 0;
+        for(size_t byte = 0; byte < 256; ++byte){
+            next[byte] = start;
+            start += count[byte];
+        }
+        if(inScratch){
+            for(T* elt = scratch; elt != scratch + size; ++elt){
+                *(begin + next[(radixBits(key(*elt)) >> shift) & 0xff]++) = std::move(*elt);
+            }
+        }
         else{
-            *(it++) = (comp(*left, *right)) ? *(left++) : *(right++);
+            for(InputIterator it = begin; it != end; ++it){
+                scratch[next[(radixBits(key(*it)) >> shift) & 0xff]++] = std::move(*it);
+            }
+        }
+        inScratch = !inScratch;
+    }
+    if(inScratch) std::move(scratch, scratch + size, begin);
+}
+
+// A stable radix sort by the ascending order of key(element), which must be
+// an integer or float or double. Ranges that fit in the cache are sorted LSD:
+// one pass counts all bytes of the keys, then one pass per byte, from the
+// lowest up, moves every element into the bucket of its byte. Larger ranges
+// are first split MSD by their highest byte. Bytes that are the same in all
+// keys are skipped, so small keys in a wide type cost fewer passes.
+// O(n * sizeof(key)) time and n elements of extra space.
+// REQUIRE: the elements are default constructible
+template<typename InputIterator, typename KEY_FUNCTOR = IdentityKey>
+void radixSort(InputIterator begin, InputIterator end, KEY_FUNCTOR key = KEY_FUNCTOR()){
+    using T = typename iterator_traits<InputIterator>::value_type;
+    if(end - begin < 2) return;
+    vector<T> scratch((end - begin >= RADIX_MIN_SIZE) ? static_cast<size_t>(end - begin) : 0);
+    radixSortLoop(begin, end, scratch.data(), sizeof(radixBits(key(*begin))), key);
+}
+
+// EFFECT: return the bucket of s at depth, 0 if s ends before depth and
+//         1 + the character otherwise
+template<typename STRING>
+size_t stringBucket(const STRING& s, size_t depth){
+    return (depth < s.size()) ? 1 + static_cast<unsigned char>(s[depth]) : 0;
+}
+
+// REQUIRE: all keys in [begin, end) agree in their first depth characters,
+//          buffer has room for end - begin elements
+// MODIFY: sort [begin, end) by the characters from depth on, with at most
+//         log(end - begin) nested calls
+template<typename InputIterator, typename KEY_FUNCTOR>
+void stringRadixSortLoop(InputIterator begin, InputIterator end, size_t depth, KEY_FUNCTOR key,
+                         vector<typename iterator_traits<InputIterator>::value_type>& buffer){
+    using T = typename iterator_traits<InputIterator>::value_type;
+    size_t count[257];
+    while(end - begin >= RADIX_MIN_SIZE){
+        fill(count, count + 257, 0);
+        for(InputIterator it = begin; it != end; ++it) count[stringBucket(key(*it), depth)]++;
+        size_t size = static_cast<size_t>(end - begin);
+        // all keys have the same character here, go on with the next one
+        size_t only = stringBucket(key(*begin), depth);
+        if(count[only] == size){
+            if(only == 0) return;
+            ++depth;
+            continue;
+        }
+        size_t start = 0;
+        for(size_t bucket = 0; bucket < 257; ++bucket){
+            size_t bucketSize = count[bucket];
+            count[bucket] = start;
+            start += bucketSize;
+        }
+        for(InputIterator it = begin; it != end; ++it){
+            buffer[count[stringBucket(key(*it), depth)]++] = std::move(*it);
+        }
+        std::move(buffer.begin(), buffer.begin() + size, begin);
+        // now count[bucket] is where the next bucket starts, the keys in
+        // bucket 0 end at depth and are equal. The largest other bucket is
+        // sorted by this loop and only the smaller ones, at most half of the
+        // keys each, recursively, so keys with long common prefixes do not
+        // nest one call per character
+        size_t largest = 1;
+        for(size_t bucket = 2; bucket < 257; ++bucket){
+            if(count[bucket] - count[bucket - 1] > count[largest] - count[largest - 1]) largest = bucket;
+        }
+        for(size_t bucket = 1; bucket < 257; ++bucket){
+            if(bucket != largest && count[bucket] - count[bucket - 1] > 1){
+                stringRadixSortLoop(begin + count[bucket - 1], begin + count[bucket], depth + 1, key, buffer);
+            }
+        }
+        end = begin + count[largest];
+        begin += count[largest - 1];
+        ++depth;
+    }
+    insertionSort(begin, end, [&key, depth](const T& a, const T& b){
+        const auto& keyA = key(a);
+        const auto& keyB = key(b);
+        for(size_t i = depth; i < keyA.size() && i < keyB.size(); ++i){
+            unsigned char charA = static_cast<unsigned char>(keyA[i]);
+            unsigned char charB = static_cast<unsigned char>(keyB[i]);
+            if(charA != charB) return charA < charB;
+        }
+        return keyA.size() < keyB.size();
+    });
+}
+
+// A stable MSD radix sort by key(element), which must be a string (anything
+// with size() and operator[] of chars), in the order of std::string's <.
+// Every range of elements with a common prefix is split into one bucket per
+// next character, short ranges are finished by insertionSort(). O(total
+// length of the distinguishing prefixes) time and n elements of extra space.
+// REQUIRE: the elements are default constructible
+template<typename InputIterator, typename KEY_FUNCTOR = IdentityKey>
+void stringRadixSort(InputIterator begin, InputIterator end, KEY_FUNCTOR key = KEY_FUNCTOR()){
+    using T = typename iterator_traits<InputIterator>::value_type;
+    vector<T> buffer((end - begin >= RADIX_MIN_SIZE) ? static_cast<size_t>(end - begin) : 0);
+    stringRadixSortLoop(begin, end, 0, key, buffer);
+}
+
+// Reads a file front to back through a buffer of bufferBytes bytes, so the
+// merge of many runs reads each of them in long sequential pieces.
+class BlockReader {
+public:
+    BlockReader(FILE* file, size_t bufferBytes)
+        : file{ file }, buffer(max(bufferBytes, size_t(1))), next{ 0 }, filled{ 0 } {}
+
+    // MODIFY: copy the next size bytes of the file to out
+    // EFFECT: return false if the file has ended
+    bool read(void* out, size_t size){
+        char* dst = static_cast<char*>(out);
+        size_t copied = 0;
+        while(copied < size){
+            if(this->next == this->filled && !this->refill()){
+                if(copied == 0) return false;
+                throw runtime_error("externalSort: the file ends inside a record");
+            }
+            size_t count = min(size - copied, this->filled - this->next);
+            memcpy(dst + copied, &this->buffer[this->next], count);
+            this->next += count;
+            copied += count;
+        }
+        return true;
+    }
+
+    // MODIFY: read the characters up to the next '\n', or up to the end of
+    //         the file, into line
+    // EFFECT: return false if the file has ended
+    bool readLine(string& line){
+        line.clear();
+        bool any = false;
+        while(this->next < this->filled || this->refill()){
+            any = true;
+            const char* start = &this->buffer[this->next];
+            size_t left = this->filled - this->next;
+            const char* newline = static_cast<const char*>(memchr(start, '\n', left));
+            if(newline != nullptr){
+                line.append(start, newline);
+                this->next += static_cast<size_t>(newline - start) + 1;
+                return true;
+            }
+            line.append(start, left);
+            this->next = this->filled;
+        }
+        return any;
+    }
+
+private:
+    FILE* file;
+    vector<char> buffer;
+    size_t next;
+    size_t filled;
+
+    // EFFECT: read the next block of the file, return false if there is none
+    bool refill(){
+        this->filled = fread(this->buffer.data(), 1, this->buffer.size(), this->file);
+        this->next = 0;
+        if(this->filled == 0 && ferror(this->file)) throw runtime_error("externalSort: cannot read a file");
+        return this->filled > 0;
+    }
+}; // BlockReader
+
+// Writes a file front to back through a buffer of bufferBytes bytes. Call
+// flush() when done, the destructor does not.
+class BlockWriter {
+public:
+    BlockWriter(FILE* file, size_t bufferBytes) : file{ file } {
+        this->buffer.reserve(max(bufferBytes, size_t(1)));
+    }
+
+    void write(const void* data, size_t size){
+        if(this->buffer.size() + size > this->buffer.capacity()) this->flush();
+        const char* src = static_cast<const char*>(data);
+        if(size > this->buffer.capacity()) this->put(src, size);
+        else this->buffer.insert(this->buffer.end(), src, src + size);
+    }
+
+    void flush(){
+        this->put(this->buffer.data(), this->buffer.size());
+        this->buffer.clear();
+    }
+
+private:
+    FILE* file;
+    vector<char> buffer;
+
+    void put(const char* data, size_t size){
+        if(fwrite(data, 1, size, this->file) != size) throw runtime_error("externalSort: cannot write a file");
+    }
+}; // BlockWriter
+
+// How externalSort() reads, writes and sizes the elements of a file of
+// fixed-width binary records, which are copied byte by byte.
+template<typename RECORD>
+struct RecordFormat {
+    static_assert(is_trivially_copyable<RECORD>::value,
+                  "records are read and written as bytes, RECORD must be trivially copyable");
+    using value_type = RECORD;
+
+    static bool read(BlockReader& in, RECORD& record){ return in.read(&record, sizeof(RECORD)); }
+    static void write(BlockWriter& out, const RECORD& record){ out.write(&record, sizeof(RECORD)); }
+    // the record, and its place in the buffer of mergeSort()
+    static size_t memory(const RECORD&){ return 2 * sizeof(RECORD); }
+};
+
+// The same for a text file of lines that end with '\n'. A last line without
+// one gets one in the sorted file.
+struct LineFormat {
+    using value_type = string;
+
+    static bool read(BlockReader& in, string& line){ return in.readLine(line); }
+    static void write(BlockWriter& out, const string& line){
+        out.write(line.data(), line.size());
+        out.write("\n", 1);
+    }
+    static size_t memory(const string& line){ return 2 * sizeof(string) + line.size() + 1; }
+};
+
+// A tournament over the current elements of k sorted sources, to merge them.
+// Node 0 holds the source whose element wins, every other inner node the
+// source that lost the match played there. When the winning source moves on
+// to its next element, only the matches on the way from its leaf to the root
+// are played again: log(k) comparisons per element, half of what a binary
+// heap of the elements needs. Ties go to the source with the lower index, so
+// the merge is stable.
+template<typename T, typename COMP_FUNCTOR>
+class LoserTree {
+public:
+    LoserTree(size_t sources, COMP_FUNCTOR comp)
+        : heads(sources), exhausted(sources, false), nodes(max(sources, size_t(1)), 0), comp{ comp } {}
+
+    // EFFECT: return the current element of source, set all of them before
+    //         build() and the one of winner() before update()
+    T& head(size_t source){ return this->heads[source]; }
+
+    // MODIFY: mark that source has no elements left
+    void exhaust(size_t source){ this->exhausted[source] = true; }
+
+    // MODIFY: play all matches
+    void build(){
+        size_t k = this->heads.size();
+        if(k == 0) return;
+        // winners[n] is the winner of the matches below node n
+        vector<size_t> winners(2 * k);
+        for(size_t source = 0; source < k; ++source) winners[k + source] = source;
+        for(size_t node = k - 1; node >= 1; --node){
+            size_t left = winners[2 * node];
+            size_t right = winners[2 * node + 1];
+            bool leftWins = this->beats(left, right);
+            winners[node] = leftWins ? left : right;
+            this->nodes[node] = leftWins ? right : left;
+        }
+        this->nodes[0] = (k == 1) ? 0 : winners[1];
+    }
+
+    size_t winner() const { return this->nodes[0]; }
+
+    // EFFECT: return true if all sources are exhausted
+    bool empty() const { return this->heads.empty() || this->exhausted[this->nodes[0]]; }
+
+    // REQUIRE: the element of winner() was replaced, or it was exhausted
+    // MODIFY: play the matches of winner() again
+    void update(){
+        size_t k = this->heads.size();
+        size_t winner = this->nodes[0];
+        for(size_t node = (k + winner) / 2; node >= 1; node /= 2){
+            if(this->beats(this->nodes[node], winner)) swap(this->nodes[node], winner);
+        }
+        this->nodes[0] = winner;
+    }
+
+private:
+    vector<T> heads;
+    vector<bool> exhausted;
+    vector<size_t> nodes;
+    COMP_FUNCTOR comp;
+
+    // EFFECT: return true if source a goes before source b
+    bool beats(size_t a, size_t b) const {
+        if(this->exhausted[a]) return false;
+        if(this->exhausted[b]) return true;
+        if(this->comp(this->heads[a], this->heads[b])) return true;
+        if(this->comp(this->heads[b], this->heads[a])) return false;
+        return a < b;
+    }
+}; // LoserTree
+
+using FilePtr = unique_ptr<FILE, int(*)(FILE*)>;
+
+// each run read during a merge gets a buffer of at least this many bytes
+const size_t MERGE_BUFFER_BYTES = 1 << 20;
+// at most this many runs are merged at once, which also bounds the number of
+// open run files
+const size_t MAX_FAN_IN = 128;
+
+// REQUIRE: the files [first, last) hold sorted runs
+// MODIFY: merge the runs into out, reading each through a buffer of an equal
+//         share of memoryBytes
+template<typename FORMAT, typename COMP_FUNCTOR>
+void mergeRunFiles(vector<FilePtr>::iterator first, vector<FilePtr>::iterator last, FILE* out,
+                   COMP_FUNCTOR comp, size_t memoryBytes){
+    size_t count = static_cast<size_t>(last - first);
+    size_t bufferBytes = memoryBytes / (count + 1);
+    vector<BlockReader> readers;
+    readers.reserve(count);
+    LoserTree<typename FORMAT::value_type, COMP_FUNCTOR> tree(count, comp);
+    for(size_t run = 0; run < count; ++run){
+        rewind(first[run].get());
+        readers.emplace_back(first[run].get(), bufferBytes);
+        if(!FORMAT::read(readers[run], tree.head(run))) tree.exhaust(run);
+    }
+    tree.build();
+    BlockWriter writer(out, bufferBytes);
+    while(!tree.empty()){
+        size_t run = tree.winner();
+        FORMAT::write(writer, tree.head(run));
+        if(!FORMAT::read(readers[run], tree.head(run))) tree.exhaust(run);
+        tree.update();
+    }
+    writer.flush();
+}
+
+// REQUIRE: the files [first, last) hold sorted runs
+// EFFECT: merge the runs into a new run and return it
+template<typename FORMAT, typename COMP_FUNCTOR>
+FilePtr mergeToRun(vector<FilePtr>::iterator first, vector<FilePtr>::iterator last,
+                   COMP_FUNCTOR comp, size_t memoryBytes){
+    FilePtr run(tmpfile(), &fclose);
+    if(!run) throw runtime_error("externalSort: cannot create a run file");
+    mergeRunFiles<FORMAT>(first, last, run.get(), comp, memoryBytes);
+    return run;
+}
+
+// Sort a file that may be much larger than memory into outputPath, using
+// about memoryBytes of memory. FORMAT says what an element of the file is:
+// RecordFormat<RECORD> for fixed-width binary records, LineFormat for lines
+// of text, e.g.
+//     externalSort<LineFormat>("app.log", "sorted.log", std::less<string>());
+// First the input is read in chunks that fill the memory, each chunk is
+// sorted by mergeSort() and written to a temporary file as a sorted run.
+// Then the runs are merged by a LoserTree over the first unread element of
+// every run, each run is read through a large buffer. At most fanIn runs are
+// merged at once, as many as buffers of MERGE_BUFFER_BYTES fit in memory, up
+// to MAX_FAN_IN: whenever fanIn runs of the same level are written, they are
+// merged into one run of the next level, like the carries of a counter. The
+// sort is stable, and takes two passes over the data, plus one per level.
+template<typename FORMAT, typename COMP_FUNCTOR>
+void externalSort(const string& inputPath, const string& outputPath, COMP_FUNCTOR comp,
+                  size_t memoryBytes = size_t(256) << 20){
+    using T = typename FORMAT::value_type;
+    FilePtr input(fopen(inputPath.c_str(), "rb"), &fclose);
+    if(!input) throw runtime_error("externalSort: cannot open " + inputPath);
+    // a reader for the input and a writer for the runs, the rest holds a chunk
+    size_t ioBytes = min(memoryBytes / 8, size_t(1) << 24);
+    size_t chunkBytes = memoryBytes - 2 * ioBytes;
+    BlockReader reader(input.get(), ioBytes);
+    size_t fanIn = min(max(memoryBytes / MERGE_BUFFER_BYTES, size_t(2)), MAX_FAN_IN);
+
+    // levels[i] holds the runs made by merging fanIn runs of level i - 1,
+    // every run is longer, and holds earlier elements, than those below it
+    vector<vector<FilePtr>> levels;
+    vector<T> chunk;
+    bool more = true;
+    while(more){
+        chunk.clear();
+        size_t used = 0;
+        // at least one element per chunk, however little memory there is
+        while(chunk.empty() || used < chunkBytes){
+            chunk.emplace_back();
+            if(!FORMAT::read(reader, chunk.back())){
+                chunk.pop_back();
+                more = false;
+                break;
+            }
+            used += FORMAT::memory(chunk.back());
+        }
+        if(!more && levels.empty()) break;
+        if(chunk.empty()) continue;
+        mergeSort(chunk.begin(), chunk.end(), comp);
+        FilePtr run(tmpfile(), &fclose);
+        if(!run) throw runtime_error("externalSort: cannot create a run file");
+        BlockWriter writer(run.get(), ioBytes);
+        for(const T& elt : chunk) FORMAT::write(writer, elt);
+        writer.flush();
+        for(size_t level = 0; run; ++level){
+            if(level == levels.size()) levels.emplace_back();
+            levels[level].push_back(std::move(run));
+            if(levels[level].size() == fanIn){
+                // the merge buffers take the memory of the chunk
+                vector<T>().swap(chunk);
+                run = mergeToRun<FORMAT>(levels[level].begin(), levels[level].end(), comp, memoryBytes);
+                levels[level].clear();
+            }
+        }
+    }
+    input.reset();
+
+    FilePtr output(fopen(outputPath.c_str(), "wb"), &fclose);
+    if(!output) throw runtime_error("externalSort: cannot create " + outputPath);
+    if(levels.empty()){
+        // everything fit in one chunk, it needs no run
+        mergeSort(chunk.begin(), chunk.end(), comp);
+        BlockWriter writer(output.get(), ioBytes);
+        for(const T& elt : chunk) FORMAT::write(writer, elt);
+        writer.flush();
+    }
+    else{
+        vector<T>().swap(chunk);
+        // the runs in the order of their elements in the input
+        vector<FilePtr> runs;
+        for(size_t level = levels.size(); level-- > 0;){
+            for(FilePtr& run : levels[level]) runs.push_back(std::move(run));
+        }
+        while(runs.size() > fanIn){
+            // merge neighbouring runs, so equal elements keep their order
+            vector<FilePtr> merged;
+            for(size_t first = 0; first < runs.size(); first += fanIn){
+                size_t last = min(first + fanIn, runs.size());
+                merged.push_back(mergeToRun<FORMAT>(runs.begin() + first, runs.begin() + last, comp, memoryBytes));
+                for(size_t run = first; run < last; ++run) runs[run].reset();
+            }
+            runs.swap(merged);
+        }
+        mergeRunFiles<FORMAT>(runs.begin(), runs.end(), output.get(), comp, memoryBytes);
+    }
+    if(fclose(output.release()) != 0) throw runtime_error("externalSort: cannot write " + outputPath);
+}
+
+#if defined(SORT_STATS)
+// Run every sort on the same random input and print how many comparisons,
+// copies and moves of elements each one made. Built by 'make stats.exe'.
+// EFFECT: return true if v is sorted, without counting the compares, so the
+//         check does not add to the numbers of the sort it checks
+bool countedSorted(const vector<Counted<int>>& v){
+    return is_sorted(v.begin(), v.end(), [](const Counted<int>& a, const Counted<int>& b){
+        return a.get() < b.get();
+    });
+}
+
+void reportSortStats(size_t n){
+    vector<int> input(n);
+    for(int& x : input) x = rand() % 100000;
+    vector<Counted<int>> counted(input.begin(), input.end());
+    InstrumentStats& stats = InstrumentStats::global();
+    stats.reset();
+    {
+        vector<Counted<int>> v(counted);
+        {
+            InstrumentStats::Scope scope("bubbleSort");
+            bubbleSort(v);
+        }
+        assert(countedSorted(v));
+    }
+    {
+        vector<Counted<int>> v(counted);
+        {
+            InstrumentStats::Scope scope("selectionSort");
+            selectionSort(v);
+        }
+        assert(countedSorted(v));
+    }
+    {
+        vector<Counted<int>> v(counted);
+        {
+            InstrumentStats::Scope scope("insertionSort");
+            insertionSort(v.begin(), v.end(), std::less<Counted<int>>());
+        }
+        assert(countedSorted(v));
+    }
+    {
+        vector<Counted<int>> v(counted);
+        {
+            InstrumentStats::Scope scope("quickSort");
+            quickSort(v.begin(), v.end(), std::less<Counted<int>>());
+        }
+        assert(countedSorted(v));
+    }
+    {
+        vector<Counted<int>> v(counted);
+        {
+            InstrumentStats::Scope scope("heapSort");
+            heapSort(v.begin(), v.end(), std::less<Counted<int>>());
+        }
+        assert(countedSorted(v));
+    }
+    {
+        vector<Counted<int>> v(counted);
+        {
+            InstrumentStats::Scope scope("mergeSort");
+            mergeSort(v.begin(), v.end(), std::less<Counted<int>>());
+        }
+        assert(countedSorted(v));
+    }
+    {
+        vector<Counted<int>> v(counted);
+        {
+            InstrumentStats::Scope scope("radixSort");
+            radixSort(v.begin(), v.end(), [](const Counted<int>& x){ return x.get(); });
         }
+        assert(countedSorted(v));
     }
-    std::copy(temp.begin(), temp.end(), begin);
+    cout << "n = " << n << ", copies of the unsorted input are booked under 'other'\n";
+    stats.report(stdout);
 }
+#endif
 
+// testSort.cpp includes this file with SORT_TEST defined and has its own main
+#if !defined(SORT_TEST)
 int main(){
+#if defined(SORT_STATS)
+    reportSortStats(2000);
+    return 0;
+#endif
     vector<int> a{1,23,4};
     mergeSort(a.begin(), a.end(), std::less<int>());
     cout << a;
 }
+#endif
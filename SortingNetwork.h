@@ -0,0 +1,269 @@
+#ifndef SORTING_NETWORK_H
+#define SORTING_NETWORK_H
+
+#include <cmath> // for signbit
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SORTING_NETWORK_AVX2 1
+#include <immintrin.h>
+#endif
+
+
+// Branch free sorting of small blocks, the base case of quickSort and the run
+// generator of mergeSort in Sort.cpp.
+//
+// SortingNetwork<TYPE, COMP_FUNCTOR>::sort(data, size) sorts an array of up to
+// MAX_SIZE elements and returns true, or returns false and leaves the array
+// alone if it cannot sort it. For int32_t, int64_t, float and double with
+// std::less or std::greater it runs a bitonic sorting network with AVX2 when
+// the CPU has it: the block is padded to 8, 16, 32 or 64 elements and held in
+// one to sixteen vectors, so every compare-exchange is a min and a max of
+// whole vectors and no step depends on the data. Blocks of floats with a NaN
+// or a -0.0 are refused, the network would not order them like the comparator
+// does, or would swap -0.0 and 0.0, which compare equal.
+//
+// SortingNetworkFor<ITERATOR, COMP_FUNCTOR> does the same for a range of
+// iterators, which must be pointers or vector iterators to reach the network.
+
+template<typename TYPE, typename COMP_FUNCTOR>
+struct SortingNetwork {
+    static const bool ENABLED = false;
+    static const std::size_t MAX_SIZE = 0;
+
+    static bool sort(TYPE*, std::size_t) {
+        return false;
+    }
+};
+
+
+#if defined(SORTING_NETWORK_AVX2)
+
+// The AVX2 instructions used for each element type. The network moves
+// elements between lanes as 32 bit floats, so every type converts to and
+// from __m256 without changing its bits.
+template<typename TYPE>
+struct NetworkOps;
+
+template<>
+struct NetworkOps<std::int32_t> {
+    using Vec = __m256i;
+
+    __attribute__((target("avx2"))) static Vec load(const std::int32_t* p) {
+        return _mm256_load_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    __attribute__((target("avx2"))) static void store(std::int32_t* p, Vec v) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+    __attribute__((target("avx2"))) static Vec min(Vec a, Vec b) { return _mm256_min_epi32(a, b); }
+    __attribute__((target("avx2"))) static Vec max(Vec a, Vec b) { return _mm256_max_epi32(a, b); }
+    __attribute__((target("avx2"))) static __m256 toPs(Vec v) { return _mm256_castsi256_ps(v); }
+    __attribute__((target("avx2"))) static Vec fromPs(__m256 v) { return _mm256_castps_si256(v); }
+    static bool orderable(std::int32_t) { return true; }
+};
+
+template<>
+struct NetworkOps<float> {
+    using Vec = __m256;
+
+    __attribute__((target("avx2"))) static Vec load(const float* p) { return _mm256_load_ps(p); }
+    __attribute__((target("avx2"))) static void store(float* p, Vec v) { _mm256_store_ps(p, v); }
+    __attribute__((target("avx2"))) static Vec min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+    __attribute__((target("avx2"))) static Vec max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+    __attribute__((target("avx2"))) static __m256 toPs(Vec v) { return v; }
+    __attribute__((target("avx2"))) static Vec fromPs(__m256 v) { return v; }
+    static bool orderable(float x) { return x == x && !(x == 0 && std::signbit(x)); }
+};
+
+template<>
+struct NetworkOps<std::int64_t> {
+    using Vec = __m256i;
+
+    __attribute__((target("avx2"))) static Vec load(const std::int64_t* p) {
+        return _mm256_load_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    __attribute__((target("avx2"))) static void store(std::int64_t* p, Vec v) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+    // AVX2 has no 64 bit min and max, they are a compare and a blend
+    __attribute__((target("avx2"))) static Vec min(Vec a, Vec b) {
+        return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+    }
+    __attribute__((target("avx2"))) static Vec max(Vec a, Vec b) {
+        return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b));
+    }
+    __attribute__((target("avx2"))) static __m256 toPs(Vec v) { return _mm256_castsi256_ps(v); }
+    __attribute__((target("avx2"))) static Vec fromPs(__m256 v) { return _mm256_castps_si256(v); }
+    static bool orderable(std::int64_t) { return true; }
+};
+
+template<>
+struct NetworkOps<double> {
+    using Vec = __m256d;
+
+    __attribute__((target("avx2"))) static Vec load(const double* p) { return _mm256_load_pd(p); }
+    __attribute__((target("avx2"))) static void store(double* p, Vec v) { _mm256_store_pd(p, v); }
+    __attribute__((target("avx2"))) static Vec min(Vec a, Vec b) { return _mm256_min_pd(a, b); }
+    __attribute__((target("avx2"))) static Vec max(Vec a, Vec b) { return _mm256_max_pd(a, b); }
+    __attribute__((target("avx2"))) static __m256 toPs(Vec v) { return _mm256_castpd_ps(v); }
+    __attribute__((target("avx2"))) static Vec fromPs(__m256 v) { return _mm256_castps_pd(v); }
+    static bool orderable(double x) { return x == x && !(x == 0 && std::signbit(x)); }
+};
+
+
+// sort() for arithmetic TYPE, ASCENDING is true for std::less and false for
+// std::greater. The network always sorts ascending, padded with the largest
+// value, a descending result is copied out backwards.
+template<typename TYPE, bool ASCENDING>
+struct SimdSortingNetwork {
+    using Ops = NetworkOps<TYPE>;
+    // elements per vector
+    static const std::size_t WIDTH = 32 / sizeof(TYPE);
+    static const bool ENABLED = true;
+    static const std::size_t MAX_SIZE = 64;
+
+    static bool sort(TYPE* data, std::size_t size) {
+        if (size > MAX_SIZE || !hasAvx2())
+            return false;
+
+        alignas(32) TYPE block[MAX_SIZE];
+        for (std::size_t i = 0; i < size; ++i) {
+            if (!Ops::orderable(data[i]))
+                return false;
+            block[i] = data[i];
+        }
+        std::size_t blockSize = (WIDTH < 8) ? 8 : WIDTH;
+        while (blockSize < size)
+            blockSize *= 2;
+        const TYPE padding = std::numeric_limits<TYPE>::has_infinity
+            ? std::numeric_limits<TYPE>::infinity() : std::numeric_limits<TYPE>::max();
+        for (std::size_t i = size; i < blockSize; ++i)
+            block[i] = padding;
+
+        switch (blockSize / WIDTH) {
+        case 1: sortVectors<1>(block); break;
+        case 2: sortVectors<2>(block); break;
+        case 4: sortVectors<4>(block); break;
+        case 8: sortVectors<8>(block); break;
+        default: sortVectors<16>(block); break;
+        }
+
+        for (std::size_t i = 0; i < size; ++i)
+            data[i] = ASCENDING ? block[i] : block[size - 1 - i];
+        return true;
+    }
+
+private:
+    static bool hasAvx2() {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+
+    // EFFECT: sort the COUNT * WIDTH elements of block ascending
+    template<std::size_t COUNT>
+    __attribute__((target("avx2")))
+    static void sortVectors(TYPE* block) {
+        // 32 bit lanes per element
+        const int LANE_SIZE = static_cast<int>(sizeof(TYPE) / 4);
+        typename Ops::Vec v[COUNT];
+        for (std::size_t x = 0; x < COUNT; ++x)
+            v[x] = Ops::load(block + x * WIDTH);
+
+        // index of the element in its vector, for each 32 bit lane
+        const __m256i lanes = _mm256_srli_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), LANE_SIZE - 1);
+        const __m256i zero = _mm256_setzero_si256();
+        for (std::size_t k = 2; k <= COUNT * WIDTH; k *= 2) {
+            for (std::size_t j = k / 2; j > 0; j /= 2) {
+                if (j >= WIDTH) {
+                    // the elements j apart are in different vectors
+                    std::size_t distance = j / WIDTH;
+                    for (std::size_t x = 0; x < COUNT; ++x) {
+                        if (x & distance)
+                            continue;
+                        typename Ops::Vec low = Ops::min(v[x], v[x + distance]);
+                        typename Ops::Vec high = Ops::max(v[x], v[x + distance]);
+                        bool up = ((x * WIDTH) & k) == 0;
+                        v[x] = up ? low : high;
+                        v[x + distance] = up ? high : low;
+                    }
+                    continue;
+                }
+                // the elements j apart are in the same vector: compare each
+                // with a copy that has the lanes j apart swapped, and keep the
+                // min or the max lane by lane
+                const __m256i swapped = _mm256_xor_si256(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                                         _mm256_set1_epi32(static_cast<int>(j) * LANE_SIZE));
+                const __m256i lowLane = _mm256_cmpeq_epi32(_mm256_and_si256(lanes, _mm256_set1_epi32(static_cast<int>(j))), zero);
+                for (std::size_t x = 0; x < COUNT; ++x) {
+                    __m256i index = _mm256_add_epi32(lanes, _mm256_set1_epi32(static_cast<int>(x * WIDTH)));
+                    __m256i up = _mm256_cmpeq_epi32(_mm256_and_si256(index, _mm256_set1_epi32(static_cast<int>(k))), zero);
+                    __m256 takeMin = _mm256_castsi256_ps(_mm256_cmpeq_epi32(lowLane, up));
+                    typename Ops::Vec other = Ops::fromPs(_mm256_permutevar8x32_ps(Ops::toPs(v[x]), swapped));
+                    __m256 low = Ops::toPs(Ops::min(v[x], other));
+                    __m256 high = Ops::toPs(Ops::max(v[x], other));
+                    v[x] = Ops::fromPs(_mm256_blendv_ps(high, low, takeMin));
+                }
+            }
+        }
+
+        for (std::size_t x = 0; x < COUNT; ++x)
+            Ops::store(block + x * WIDTH, v[x]);
+    }
+};
+
+
+template<>
+struct SortingNetwork<std::int32_t, std::less<std::int32_t>> : SimdSortingNetwork<std::int32_t, true> {};
+template<>
+struct SortingNetwork<std::int32_t, std::greater<std::int32_t>> : SimdSortingNetwork<std::int32_t, false> {};
+template<>
+struct SortingNetwork<std::int64_t, std::less<std::int64_t>> : SimdSortingNetwork<std::int64_t, true> {};
+template<>
+struct SortingNetwork<std::int64_t, std::greater<std::int64_t>> : SimdSortingNetwork<std::int64_t, false> {};
+template<>
+struct SortingNetwork<float, std::less<float>> : SimdSortingNetwork<float, true> {};
+template<>
+struct SortingNetwork<float, std::greater<float>> : SimdSortingNetwork<float, false> {};
+template<>
+struct SortingNetwork<double, std::less<double>> : SimdSortingNetwork<double, true> {};
+template<>
+struct SortingNetwork<double, std::greater<double>> : SimdSortingNetwork<double, false> {};
+
+#endif // SORTING_NETWORK_AVX2
+
+
+template<typename ITERATOR, typename COMP_FUNCTOR>
+struct SortingNetworkFor {
+    using TYPE = typename std::iterator_traits<ITERATOR>::value_type;
+    using Network = SortingNetwork<TYPE, COMP_FUNCTOR>;
+
+    // the network sorts arrays, the elements must be next to each other
+    static const bool ENABLED = Network::ENABLED
+        && (std::is_same<ITERATOR, TYPE*>::value
+            || std::is_same<ITERATOR, typename std::vector<TYPE>::iterator>::value);
+    static const std::size_t MAX_SIZE = ENABLED ? Network::MAX_SIZE : 0;
+
+    // EFFECT: sort [begin, end) and return true, or return false if the
+    //         network cannot sort it
+    static bool sort(ITERATOR begin, ITERATOR end) {
+        return sortIf(begin, end, std::integral_constant<bool, ENABLED>());
+    }
+
+private:
+    static bool sortIf(ITERATOR begin, ITERATOR end, std::true_type) {
+        if (begin == end)
+            return true;
+        return Network::sort(&*begin, static_cast<std::size_t>(end - begin));
+    }
+    static bool sortIf(ITERATOR, ITERATOR, std::false_type) {
+        return false;
+    }
+};
+
+#endif // SORTING_NETWORK_H
@@ -5,11 +5,25 @@
 
 
 #include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include "Eecs281PQ.h"
 
-// A specialized version of the 'heap' ADT implemented as a binary heap.
-template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
-class BinaryPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+// A specialized version of the 'heap' ADT implemented as a d-ary heap.
+// ARITY is the number of children of every node, the default 2 gives the
+// classic binary heap. With ARITY 4 or 8 the tree is 2 or 3 times shallower,
+// and all children of a node are stored next to each other in 'data', so
+// fixDown() reads one contiguous group of siblings per level instead of
+// jumping to a new cache line for each of them.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, std::size_t ARITY = 2>
+class BinaryPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    static_assert(ARITY >= 2, "BinaryPQ needs at least two children per node");
+
     // This is a way to refer to the base class object.
     using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
 
@@ -22,12 +36,14 @@ public:
 
 
     // Description: Construct a heap out of an iterator range with an optional
-    //              comparison functor.
+    //              comparison functor, building it with up to threads threads
+    //              like updatePriorities(threads).
     // Runtime: O(n) where n is number of elements in range.
     template<typename InputIterator>
-    BinaryPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+    BinaryPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR(),
+             std::size_t threads = 1) :
         BaseClass{ comp }, data(start, end) {
-        this->updatePriorities();
+        this->updatePriorities(threads);
     } // BinaryPQ
 
 
@@ -41,36 +57,146 @@ public:
     //              'rebuilds' the heap by fixing the heap invariant.
     // Runtime: O(n)
     void updatePriorities() override{
-        // start from the first internal node
-        size_t i = this->data.size() / 2;
-        while(i >= 1){
-            this->fixDown(i);
-            --i;
+        this->updatePriorities(1);
+    } // updatePriorities()
+
+
+    // Description: Rebuild the heap like updatePriorities() with up to threads
+    //              threads, 0 means one per core. The heap is built depth
+    //              first: every subtree is finished right after its children's
+    //              subtrees, while they are still in cache. With more than one
+    //              thread, the subtrees below the first level that has at least
+    //              4 nodes per thread are independent and are built
+    //              concurrently, then the few levels above them are fixed.
+    // REQUIRE: with threads != 1, compare may be called from several threads
+    //          at once
+    // Runtime: O(n / threads + threads * log(n))
+    void updatePriorities(std::size_t threads){
+        std::size_t size = this->data.size();
+        if(size < 2) return;
+        if(threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        if(threads == 1 || size < PARALLEL_MIN_SIZE){
+            this->buildSubtree(1);
+            return;
+        }
+
+        std::size_t levelBegin = 1;
+        std::size_t levelSize = 1;
+        while(levelSize < 4 * threads && levelBegin + levelSize <= size){
+            levelBegin += levelSize;
+            levelSize *= ARITY;
         }
+        std::size_t levelEnd = std::min(levelBegin + levelSize, size + 1);
+        // contiguous runs of subtree roots per thread, this thread takes the last one
+        std::size_t perThread = (levelEnd - levelBegin + threads - 1) / threads;
+        std::vector<std::thread> workers;
+        std::size_t first = levelBegin;
+        while(levelEnd - first > perThread){
+            workers.emplace_back([this, first, perThread](){
+                for(std::size_t i = first; i < first + perThread; ++i) this->buildSubtree(i);
+            });
+            first += perThread;
+        }
+        for(std::size_t i = first; i < levelEnd; ++i) this->buildSubtree(i);
+        for(std::thread& worker : workers) worker.join();
+
+        for(std::size_t i = levelBegin - 1; i >= 1; --i) this->fixDown(i);
     } // updatePriorities()
 
 
     // Description: Add a new element to the heap.
+    // Note: A heap of a move-only TYPE still has to provide this function for
+    //       the Eecs281PQ interface, but it can only be filled with the
+    //       rvalue push() and emplace() below, this one throws
+    //       std::logic_error.
     // Runtime: O(log(n))
     void push(const TYPE & val) override{
-        this->data.push_back(val);
+        this->pushCopy(val, std::is_copy_constructible<TYPE>());
+    } // push()
+
+
+    // Description: Add a new element to the heap by moving it in.
+    // Runtime: O(log(n))
+    void push(TYPE && val){
+        this->data.push_back(std::move(val));
         this->fixUp(this->data.size());
     } // push()
 
 
+    // Description: Construct a new element in place from args and add it to
+    //              the heap.
+    // Runtime: O(log(n))
+    template<typename... Args>
+    void emplace(Args&&... args){
+        this->data.emplace_back(std::forward<Args>(args)...);
+        this->fixUp(this->data.size());
+    } // emplace()
+
+
+    // Description: Add all elements of an iterator range to the heap. The
+    //              elements are appended first, then either each of them is
+    //              fixed up or the whole heap is rebuilt, whichever is cheaper
+    //              for the size of the batch.
+    // Runtime: O(min(k * log(n), n)) where k is number of elements in range.
+    template<typename InputIterator>
+    void push_range(InputIterator start, InputIterator end){
+        std::size_t oldSize = this->data.size();
+        this->data.insert(this->data.end(), start, end);
+        std::size_t added = this->data.size() - oldSize;
+
+        // a rebuild touches every element a constant number of times,
+        // fixing up touches up to one element per level for each new one
+        std::size_t depth = 1;
+        for(std::size_t levelSize = ARITY; levelSize < this->data.size(); levelSize *= ARITY){
+            ++depth;
+        }
+        if(added * depth > this->data.size()){
+            this->updatePriorities();
+        }
+        else{
+            for(std::size_t i = oldSize + 1; i <= this->data.size(); ++i){
+                this->fixUp(i);
+            }
+        }
+    } // push_range()
+
+
     // Description: Remove the most extreme (defined by 'compare') element from
     //              the heap.
     // Note: We will not run tests on your code that would require it to pop an
     // element when the heap is empty. Though you are welcome to if you are
     // familiar with them, you do not need to use exceptions in this project.
-    // Runtime: O(log(n))
+    // Runtime: O(ARITY * log(n) / log(ARITY))
     void pop() override {
-        this->swapByIndex(1, this->data.size());
-        this->data.pop_back();
-        this->fixDown(1);
+        if(this->data.size() > 1){
+            this->getByIndex(1) = std::move(this->data.back());
+            this->data.pop_back();
+            this->fixDown(1);
+        }
+        else this->data.pop_back();
     } // pop()
 
 
+    // Description: Remove the most extreme element from the heap and return
+    //              it by value, the element is moved out rather than copied.
+    // Runtime: O(ARITY * log(n) / log(ARITY))
+    TYPE pop_value(){
+        TYPE result = std::move(this->getByIndex(1));
+        this->pop();
+        return result;
+    } // pop_value()
+
+
+    // Description: Replace the most extreme element with val and restore the
+    //              heap, cheaper than a pop() followed by a push().
+    // REQUIRE: the heap is not empty
+    // Runtime: O(ARITY * log(n) / log(ARITY))
+    void replace_top(TYPE val){
+        this->getByIndex(1) = std::move(val);
+        this->fixDown(1);
+    } // replace_top()
+
+
     // Description: Return the most extreme (defined by 'compare') element of
     //              the heap.  This should be a reference for speed.  It MUST be
     //              const because we cannot allow it to be modified, as that
@@ -99,6 +225,9 @@ private:
     // Note: This vector *must* be used your heap implementation.
     std::vector<TYPE> data;
     // COMP_FUNCTOR comp; (base class)
+
+    // smaller heaps are not worth starting threads for
+    static const std::size_t PARALLEL_MIN_SIZE = 1 << 16;
     
     // REQUIRE: index >= 1 && index <= size of vector
     // EFFECT: get element reference by index
@@ -109,41 +238,85 @@ private:
         return this->data[index - 1];
     }
     
-    //REQUIRE:  1 <= index <= size of vector
-    //MODIFY: swap the elements in specified index
-    void swapByIndex(std::size_t index1, std::size_t index2){
-        std::swap(this->data[index1 - 1], this->data[index2 - 1]);
+    // MODIFY: copy val to the back of the heap and fix it up
+    void pushCopy(const TYPE& val, std::true_type){
+        this->data.push_back(val);
+        this->fixUp(this->data.size());
+    }
+
+    // push() is virtual, so it exists for move-only TYPEs too and can only
+    // fail when it is called
+    void pushCopy(const TYPE&, std::false_type){
+        throw std::logic_error("BinaryPQ: push(const TYPE&) on a heap of move-only elements");
     }
     
+    // REQUIRE: index >= 2
+    // EFFECT: return the index of the parent of index
+    static std::size_t parentIndex(std::size_t index){
+        return (index - 2) / ARITY + 1;
+    }
+
+    // REQUIRE: index >= 1
+    // EFFECT: return the index of the leftmost child of index, the other
+    //         children follow it directly
+    static std::size_t firstChildIndex(std::size_t index){
+        return ARITY * (index - 1) + 2;
+    }
+
+    // REQUIRE: 1 <= index <= size of vector
+    // MODIFY: make the subtree of index a heap, children's subtrees first
+    void buildSubtree(std::size_t index){
+        std::size_t childIndex = this->firstChildIndex(index);
+        if(childIndex > this->data.size()) return;
+        std::size_t lastChild = std::min(childIndex + ARITY - 1, this->data.size());
+        // leaves are heaps already, only children with children of their own
+        for(std::size_t i = childIndex; i <= lastChild && this->firstChildIndex(i) <= this->data.size(); ++i){
+            this->buildSubtree(i);
+        }
+        this->fixDown(index);
+    }
+
     // REQUIRE: index is location on where we change an element
-    // MODIFY: fix up the data vector to build a valid heap
+    // MODIFY: fix up the data vector to build a valid heap. The element is
+    //         moved out once and the smaller parents are moved down into the
+    //         hole it leaves, so each level costs one move instead of a swap
     void fixUp(std::size_t index){
+        TYPE moving = std::move(this->getByIndex(index));
         while(index != 1){
+            std::size_t parent = this->parentIndex(index);
             // if its parent is smaller than it
-            if(this->compare(this->getByIndex(index / 2), this->getByIndex(index))){
-                this->swapByIndex(index, index/2);
+            if(this->compare(this->getByIndex(parent), moving)){
+                this->getByIndex(index) = std::move(this->getByIndex(parent));
             }
             else break;
-            index = index / 2;
+            index = parent;
         }
+        this->getByIndex(index) = std::move(moving);
     }
     
+    // REQUIRE: 1 <= index <= size of vector
+    // MODIFY: fix down the data vector to build a valid heap, moving the
+    //         larger children up into the hole in the same way as fixUp()
     void fixDown(std::size_t index){
+        TYPE moving = std::move(this->getByIndex(index));
         // until we reach the leaf node
-        while(index <= this->data.size() / 2){
-            size_t childIndex = index * 2;
-            // if we have two child and the right child is larger than left child
-            if(childIndex < this->data.size() && 
-                this->compare(this->getByIndex(childIndex), this->getByIndex(childIndex + 1))){
-                ++childIndex;
+        while(this->firstChildIndex(index) <= this->data.size()){
+            std::size_t childIndex = this->firstChildIndex(index);
+            std::size_t lastChild = std::min(childIndex + ARITY - 1, this->data.size());
+            // find the largest child among the siblings
+            for(std::size_t i = childIndex + 1; i <= lastChild; ++i){
+                if(this->compare(this->getByIndex(childIndex), this->getByIndex(i))){
+                    childIndex = i;
+                }
             }
             // if this element if smaller than his child
-            if(this->compare(this->getByIndex(index), this->getByIndex(childIndex))){
-                this->swapByIndex(index, childIndex);
+            if(this->compare(moving, this->getByIndex(childIndex))){
+                this->getByIndex(index) = std::move(this->getByIndex(childIndex));
             }
             else break;
             index = childIndex;
         }
+        this->getByIndex(index) = std::move(moving);
     }
     
 }; // BinaryPQ
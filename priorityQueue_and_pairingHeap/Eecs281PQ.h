@@ -9,9 +9,15 @@
 
 // A simple interface that implements a generic priority queue.
 // Runtime specifications assume constant time comparison and copying.
+// This is the interface for code that picks a priority queue at runtime. The
+// implementations are all final, so code that knows the concrete type at
+// compile time calls them without virtual dispatch, see StaticPQ.h.
 template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
 class Eecs281PQ {
 public:
+    using value_type = TYPE;
+    using compare_type = COMP_FUNCTOR;
+
     virtual ~Eecs281PQ() {}
 
     // Description: Add a new element to the priority queue.
@@ -0,0 +1,367 @@
+// Project identifier: 0E04A31E0D60C01986ACB20081C9D8722A1899B6
+
+#ifndef EXTERNALPQ_H
+#define EXTERNALPQ_H
+
+#include "BinaryPQ.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+// A priority queue that can hold more elements than fit in memory. New
+// elements go into an in-memory heap of at most memoryElements elements.
+// When it is full, it is written in priority order to a sorted run in a
+// temporary file. The most extreme element is then either the top of the
+// in-memory heap or the best first unread element of a run, the first unread
+// elements of all runs are kept in a small BinaryPQ of run heads. Runs are
+// written and read sequentially through buffers of bufferElements elements.
+//
+// Every run has a level: spilled runs have level 0, and whenever FAN_IN runs
+// of one level are on disk, what is left of them is merged into one run of
+// the next level. So there are at most (FAN_IN - 1) runs per level and
+// O(log(n / memoryElements)) levels, which bounds the open files and the run
+// buffers in memory.
+//
+// The elements are written to disk byte by byte, so TYPE must be trivially
+// copyable. Like the other heaps it has push(), pop() and top(), but it is not
+// an Eecs281PQ: elements on disk can not be reordered by updatePriorities().
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+class ExternalPQ {
+    static_assert(std::is_trivially_copyable<TYPE>::value,
+                  "ExternalPQ stores elements in files, TYPE must be trivially copyable");
+
+public:
+    // the number of runs of one level that are merged into one run
+    static const std::size_t FAN_IN = 8;
+
+    // Description: Construct an empty priority queue that keeps at most
+    //              memoryElements elements in memory before spilling to disk,
+    //              and moves bufferElements elements per file read or write.
+    // Runtime: O(1)
+    explicit ExternalPQ(std::size_t memoryElements, std::size_t bufferElements = 4096,
+                        COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        compare{ comp }, memoryLimit{ memoryElements == 0 ? 1 : memoryElements },
+        bufferSize{ bufferElements == 0 ? 1 : bufferElements },
+        heads{ HeadComp{ comp } }, pqSize{ 0 } {
+    } // ExternalPQ()
+
+    ExternalPQ(const ExternalPQ&) = delete;
+    ExternalPQ& operator=(const ExternalPQ&) = delete;
+
+
+    // Description: Add a new element, spilling the in-memory heap to a new run
+    //              first if it is full. If that fails, the exception is passed
+    //              on and the queue keeps all of its elements.
+    // Runtime: O(log(m)), plus O(m log(m)) and writing m elements when the
+    //          in-memory heap of m elements is spilled, plus the merges that
+    //          makes necessary
+    void push(const TYPE& val) {
+        if(this->memory.size() >= this->memoryLimit) this->spill();
+        this->memory.push_back(val);
+        std::push_heap(this->memory.begin(), this->memory.end(), this->compare);
+        this->pqSize++;
+    } // push()
+
+
+    // Description: Remove the most extreme (defined by 'compare') element.
+    // Runtime: O(log(m) + log(number of runs)), plus reading bufferElements
+    //          elements whenever a run buffer runs empty
+    void pop() {
+        if(this->topInMemory()){
+            std::pop_heap(this->memory.begin(), this->memory.end(), this->compare);
+            this->memory.pop_back();
+        }
+        else{
+            std::size_t index = this->heads.pop_value().run;
+            this->pushHead(index);
+        }
+        this->pqSize--;
+    } // pop()
+
+
+    // Description: Return the most extreme (defined by 'compare') element.
+    // Runtime: O(1)
+    const TYPE& top() const {
+        if(this->topInMemory()) return this->memory.front();
+        return this->heads.top().value;
+    } // top()
+
+
+    // Description: Get the number of elements, in memory and on disk.
+    // Runtime: O(1)
+    std::size_t size() const {
+        return this->pqSize;
+    } // size()
+
+
+    // Description: Return true if the priority queue is empty.
+    // Runtime: O(1)
+    bool empty() const {
+        return this->pqSize == 0;
+    } // empty()
+
+
+    // Description: Get the number of runs on disk that still hold elements.
+    // Runtime: O(number of runs)
+    std::size_t runCount() const {
+        std::size_t count = 0;
+        for(const Run& run : this->runs){
+            if(run.file) count++;
+        }
+        return count;
+    } // runCount()
+
+
+private:
+    using FilePtr = std::unique_ptr<std::FILE, int(*)(std::FILE*)>;
+
+    // A sorted run in a temporary file, read through a buffer. Its first
+    // unread element is in heads while file is open.
+    struct Run {
+        FilePtr file;
+        // elements still on disk, not yet in buffer
+        std::size_t unread;
+        std::vector<TYPE> buffer;
+        std::size_t next;
+        std::size_t level;
+    };
+
+    // The first unread element of a run.
+    struct Head {
+        TYPE value;
+        std::size_t run;
+    };
+
+    struct HeadComp {
+        COMP_FUNCTOR compare;
+
+        bool operator()(const Head& a, const Head& b) const {
+            return compare(a.value, b.value);
+        }
+    };
+
+    // Reads what is left of a run during a merge without changing the run,
+    // so a failed merge can be undone by moving the file back to start. The
+    // position is an fpos_t, not a long offset, which is 32 bits on some
+    // platforms and would not reach past 2 GB into a run.
+    struct Cursor {
+        const Run* run;
+        std::fpos_t start;
+        std::size_t unread;
+        std::vector<TYPE> chunk;
+        std::size_t chunkNext;
+    };
+
+    COMP_FUNCTOR compare;
+    std::size_t memoryLimit;
+    std::size_t bufferSize;
+    // a heap by std::push_heap, so spill() can sort it in place
+    std::vector<TYPE> memory;
+    BinaryPQ<Head, HeadComp> heads;
+    std::vector<Run> runs;
+    std::size_t pqSize;
+
+    // EFFECT: return true if the most extreme element is in the in-memory heap
+    bool topInMemory() const {
+        if(this->heads.empty()) return true;
+        if(this->memory.empty()) return false;
+        return !this->compare(this->memory.front(), this->heads.top().value);
+    }
+
+    // MODIFY: move the whole in-memory heap, in priority order, to a new run
+    //         of level 0, then merge full levels. If writing the run fails
+    //         the heap is restored
+    void spill() {
+        FilePtr file(std::tmpfile(), &std::fclose);
+        if(!file) throw std::runtime_error("ExternalPQ: cannot create a run file");
+        // the most extreme element goes last, it becomes the run's head and
+        // the rest is written from back to front
+        std::sort_heap(this->memory.begin(), this->memory.end(), this->compare);
+        try{
+            this->runs.reserve(this->runs.size() + 1);
+            this->writeBackwards(file.get(), this->memory.begin(), this->memory.end() - 1);
+            flush(file.get());
+            this->heads.push(Head{ this->memory.back(), this->runs.size() });
+        }
+        catch(...){
+            std::make_heap(this->memory.begin(), this->memory.end(), this->compare);
+            throw;
+        }
+        std::rewind(file.get());
+        this->runs.push_back(Run{ std::move(file), this->memory.size() - 1, std::vector<TYPE>(), 0, 0 });
+        this->memory.clear();
+        this->mergeFullLevels();
+    }
+
+    // MODIFY: write [first, last) to file, last element first
+    void writeBackwards(std::FILE* file, typename std::vector<TYPE>::const_iterator first,
+                        typename std::vector<TYPE>::const_iterator last) const {
+        std::vector<TYPE> outBuffer;
+        outBuffer.reserve(std::min<std::size_t>(this->bufferSize, static_cast<std::size_t>(last - first)));
+        while(last != first){
+            outBuffer.push_back(*--last);
+            if(outBuffer.size() == this->bufferSize){
+                write(file, outBuffer);
+                outBuffer.clear();
+            }
+        }
+        write(file, outBuffer);
+    }
+
+    // MODIFY: write all elements of buffer to file
+    static void write(std::FILE* file, const std::vector<TYPE>& buffer) {
+        if(std::fwrite(buffer.data(), sizeof(TYPE), buffer.size(), file) != buffer.size()){
+            throw std::runtime_error("ExternalPQ: cannot write a run file");
+        }
+    }
+
+    // MODIFY: write what stdio still buffers for file, so a full disk is
+    //         noticed before the run is used
+    static void flush(std::FILE* file) {
+        if(std::fflush(file) != 0) throw std::runtime_error("ExternalPQ: cannot write a run file");
+    }
+
+    // MODIFY: read the next count elements of file into buffer
+    static void read(std::FILE* file, std::vector<TYPE>& buffer, std::size_t count) {
+        buffer.resize(count);
+        if(std::fread(buffer.data(), sizeof(TYPE), count, file) != count){
+            throw std::runtime_error("ExternalPQ: cannot read a run file");
+        }
+    }
+
+    // MODIFY: push the next unread element of runs[index] to heads, refilling
+    //         its buffer from disk if needed, or close the run if it is done
+    void pushHead(std::size_t index) {
+        Run& run = this->runs[index];
+        if(run.next == run.buffer.size()){
+            if(run.unread == 0){
+                run.file.reset();
+                std::vector<TYPE>().swap(run.buffer);
+                return;
+            }
+            std::size_t count = std::min(run.unread, this->bufferSize);
+            read(run.file.get(), run.buffer, count);
+            run.unread -= count;
+            run.next = 0;
+        }
+        this->heads.push(Head{ run.buffer[run.next++], index });
+    }
+
+    // MODIFY: while a level holds FAN_IN runs, merge them into one run of the
+    //         next level
+    void mergeFullLevels() {
+        for(std::size_t level = 0; ; ++level){
+            std::size_t count = 0;
+            bool higher = false;
+            for(const Run& run : this->runs){
+                if(!run.file) continue;
+                if(run.level == level) count++;
+                if(run.level > level) higher = true;
+            }
+            if(count >= FAN_IN) this->mergeLevel(level);
+            else if(!higher) return;
+        }
+    }
+
+    // EFFECT: move the next element of cursor to out, return false if there
+    //         is none
+    bool advance(Cursor& cursor, TYPE& out) const {
+        if(cursor.chunkNext == cursor.chunk.size()){
+            if(cursor.unread == 0) return false;
+            std::size_t count = std::min(cursor.unread, this->bufferSize);
+            read(cursor.run->file.get(), cursor.chunk, count);
+            cursor.unread -= count;
+            cursor.chunkNext = 0;
+        }
+        out = cursor.chunk[cursor.chunkNext++];
+        return true;
+    }
+
+    // MODIFY: merge what is left of all runs of level into one run of
+    //         level + 1, with (FAN_IN + 1) extra buffers of bufferElements
+    //         elements. If it fails, the runs are left as they were
+    void mergeLevel(std::size_t level) {
+        FilePtr file(std::tmpfile(), &std::fclose);
+        if(!file) throw std::runtime_error("ExternalPQ: cannot create a run file");
+        std::vector<Run> live;
+        live.reserve(this->runs.size() + 1);
+        std::vector<std::size_t> newIndex(this->runs.size());
+        std::vector<Head> saved;
+        saved.reserve(this->heads.size());
+        std::vector<Cursor> cursors;
+        cursors.reserve(this->heads.size());
+        BinaryPQ<Head, HeadComp> mergeHeads{ HeadComp{ this->compare } };
+
+        // heads keeps the capacity of its vector, so putting the saved heads
+        // back can not fail
+        while(!this->heads.empty()) saved.push_back(this->heads.pop_value());
+        std::size_t total = 0;
+        std::vector<TYPE> first;
+        first.reserve(1);
+        try{
+            for(const Head& head : saved){
+                const Run& run = this->runs[head.run];
+                if(run.level != level) continue;
+                // a cursor starts with what is left in the run's buffer
+                std::fpos_t start;
+                if(std::fgetpos(run.file.get(), &start) != 0){
+                    throw std::runtime_error("ExternalPQ: cannot read a run file");
+                }
+                cursors.push_back(Cursor{ &run, start, run.unread,
+                                          std::vector<TYPE>(run.buffer.begin() + static_cast<std::ptrdiff_t>(run.next),
+                                                            run.buffer.end()), 0 });
+                mergeHeads.push(Head{ head.value, cursors.size() - 1 });
+            }
+            std::vector<TYPE> outBuffer;
+            outBuffer.reserve(this->bufferSize);
+            while(!mergeHeads.empty()){
+                Head head = mergeHeads.pop_value();
+                // the first element becomes the new run's head and is not written
+                if(total++ == 0) first.push_back(head.value);
+                else outBuffer.push_back(head.value);
+                if(outBuffer.size() == this->bufferSize){
+                    write(file.get(), outBuffer);
+                    outBuffer.clear();
+                }
+                if(this->advance(cursors[head.run], head.value)) mergeHeads.push(head);
+            }
+            write(file.get(), outBuffer);
+            flush(file.get());
+        }
+        catch(...){
+            for(Cursor& cursor : cursors){
+                std::clearerr(cursor.run->file.get());
+                std::fsetpos(cursor.run->file.get(), &cursor.start);
+            }
+            for(const Head& head : saved) this->heads.push(head);
+            throw;
+        }
+        std::rewind(file.get());
+
+        // from here nothing allocates: drop the merged and finished runs,
+        // renumber the others and rebuild heads
+        for(std::size_t i = 0; i < this->runs.size(); ++i){
+            Run& run = this->runs[i];
+            if(!run.file || run.level == level) continue;
+            newIndex[i] = live.size();
+            live.push_back(std::move(run));
+        }
+        live.push_back(Run{ std::move(file), total - 1, std::vector<TYPE>(), 0, level + 1 });
+        this->runs.swap(live);
+        for(Head head : saved){
+            if(live[head.run].level == level) continue;
+            head.run = newIndex[head.run];
+            this->heads.push(head);
+        }
+        this->heads.push(Head{ first.front(), this->runs.size() - 1 });
+    }
+}; // ExternalPQ
+
+#endif // EXTERNALPQ_H
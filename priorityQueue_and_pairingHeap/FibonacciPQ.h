@@ -0,0 +1,427 @@
+// Project identifier: 0E04A31E0D60C01986ACB20081C9D8722A1899B6
+
+#ifndef FIBONACCIPQ_H
+#define FIBONACCIPQ_H
+
+#include "Eecs281PQ.h"
+#include "NodeStore.h"
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+// A specialized version of the 'priority_queue' ADT implemented as a Fibonacci
+// heap. Nodes are handed out by addNode() like in PairingPQ, and making an
+// element more extreme with updateElt() is amortized O(1): the node is cut
+// from its parent and put into the root list, and a parent that loses a second
+// child is cut as well (cascading cut). Trees of the same degree are only
+// linked in pop().
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+class FibonacciPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+    // Each node within the Fibonacci heap
+    class Node {
+        public:
+            explicit Node(const TYPE &val)
+                : elt{ val }, parent{ nullptr }, child{ nullptr }, left{ this }, right{ this },
+                  degree{ 0 }, marked{ false }
+            {}
+
+            // Description: Allows access to the element at that Node's position.
+            // Runtime: O(1)
+            const TYPE &getElt() const { return elt; }
+
+            friend FibonacciPQ;
+
+        private:
+            TYPE elt;
+            Node* parent;
+            // any one of the children
+            Node* child;
+            // neighbours in the circular list of siblings, or of roots
+            Node* left;
+            Node* right;
+            std::size_t degree;
+            // lost a child since it became a child itself
+            bool marked;
+    }; // Node
+
+    // Description: Construct an empty priority_queue with an optional comparison functor.
+    // Runtime: O(1)
+    explicit FibonacciPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp }, root{ nullptr }, pqSize{ 0 } {}
+
+
+    // Description: Construct a priority_queue out of an iterator range with an optional
+    //              comparison functor.
+    // Runtime: O(n) where n is number of elements in range.
+    template<typename InputIterator>
+    FibonacciPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp }, root{ nullptr }, pqSize{ 0 } {
+        while(start != end){
+            this->addNode(*start);
+            ++start;
+        }
+    } // FibonacciPQ()
+
+
+    // Description: Copy constructor. The copy holds the same elements as
+    //              single node trees in one block of memory, the first pop()
+    //              links them.
+    // Runtime: O(n)
+    FibonacciPQ(const FibonacciPQ& other) : BaseClass{ other.compare }, root{ nullptr }, pqSize{ 0 } {
+        if(other.root == nullptr) return;
+        this->nodes.reserve(other.pqSize);
+        // if copying an element throws, the nodes added so far are a valid
+        // heap and are destroyed like in the destructor
+        try{
+            // preorder walk: down to the child, else right to the next sibling,
+            // else up until a sibling list is not finished yet. A list is
+            // finished when the walk comes back to the child its parent points to
+            const Node* currNode = other.root;
+            while(currNode != nullptr){
+                this->addNode(currNode->elt);
+                if(currNode->child != nullptr){
+                    currNode = currNode->child;
+                    continue;
+                }
+                while(currNode != nullptr){
+                    const Node* first = (currNode->parent == nullptr) ? other.root : currNode->parent->child;
+                    if(currNode->right != first){
+                        currNode = currNode->right;
+                        break;
+                    }
+                    currNode = currNode->parent;
+                }
+            }
+        }
+        catch(...){
+            this->destroyNodes();
+            throw;
+        }
+    } // FibonacciPQ()
+
+    // Description: Copy assignment operator.
+    // Runtime: O(n)
+    FibonacciPQ& operator=(const FibonacciPQ& rhs) {
+        FibonacciPQ temp(rhs);
+        std::swap(this->root, temp.root);
+        std::swap(this->pqSize, temp.pqSize);
+        std::swap(this->compare, temp.compare);
+        this->nodes.swap(temp.nodes);
+        return *this;
+    } // operator=()
+
+    // Description: Destructor
+    // Runtime: O(n)
+    ~FibonacciPQ() override {
+        this->destroyNodes();
+    } // ~FibonacciPQ()
+
+    // Description: Assumes that all elements inside the priority_queue are out of order and
+    //              'rebuilds' the priority_queue by fixing the priority_queue invariant.
+    //              The nodes are reused, so pointers from addNode() stay valid.
+    // Runtime: O(n)
+    void updatePriorities() override {
+        if(this->root == nullptr) return;
+        this->flatten();
+        Node* currNode = this->root->right;
+        while(currNode != this->root){
+            if(this->compare(this->root->elt, currNode->elt)) this->root = currNode;
+            currNode = currNode->right;
+        }
+    } // updatePriorities()
+
+    // MODIFY: insert the new element and update the size
+    // Runtime: O(1)
+    void push(const TYPE& val) override {
+        this->addNode(val);
+    } // push()
+
+    // MODIFY: remove the most extreme element, move its children to the root list
+    //         and link roots of the same degree until all degrees differ
+    // Runtime: Amortized O(log(n))
+    void pop() override {
+        this->nodes.destroy(this->removeRoot());
+    } // pop()
+
+    // Runtime: O(1)
+    const TYPE& top() const override {
+        return this->root->elt;
+    } // top()
+
+    // Runtime: O(1)
+    std::size_t size() const override {
+        return this->pqSize;
+    } // size()
+
+    // Runtime: O(1)
+    bool empty() const override {
+        return this->pqSize == 0;
+    } // empty()
+
+    // REQUIRE: node must points to any node in this pq
+    // MODIFY: make this priority queue valid again
+    // EFFECT: replace the old value referenced by node with new_value. If the new value
+    //         is not smaller than the old one, the node is cut from its parent if it
+    //         got larger than it. Otherwise the node is taken out like in pop() and
+    //         put back as a single node tree, since its children may now be larger
+    // Runtime: Amortized O(1) if the value does not get smaller, else amortized O(log(n))
+    void updateElt(Node* node, const TYPE & new_value) {
+        bool decreased = this->compare(new_value, node->elt);
+        if(decreased){
+            this->extract(node);
+            node->elt = new_value;
+            this->insertRoot(node);
+            return;
+        }
+        node->elt = new_value;
+        Node* parent = node->parent;
+        if(parent != nullptr && this->compare(parent->elt, node->elt)){
+            this->cut(node);
+            this->cascadingCut(parent);
+        }
+        if(this->compare(this->root->elt, node->elt)) this->root = node;
+    } // updateElt()
+
+
+    // REQUIRE: node must points to any node in this pq
+    // MODIFY: remove the element referenced by node and update pqSize, node is deleted
+    // Runtime: Amortized O(log(n))
+    void erase(Node* node) {
+        this->extract(node);
+        this->nodes.destroy(node);
+    } // erase()
+
+
+    // REQUIRE: other uses the same ordering as this pq
+    // MODIFY: move all elements of other into this pq and leave other empty, pointers
+    //         returned by other.addNode() now refer to nodes in this pq
+    // Runtime: O(1)
+    void merge(FibonacciPQ&& other) {
+        if(&other == this || other.root == nullptr) return;
+        this->nodes.absorb(other.nodes);
+        if(this->root == nullptr) this->root = other.root;
+        else{
+            this->spliceRoots(other.root);
+            if(this->compare(this->root->elt, other.root->elt)) this->root = other.root;
+        }
+        this->pqSize += other.pqSize;
+        other.root = nullptr;
+        other.pqSize = 0;
+    } // merge()
+
+
+    // MODIFY: update the root and pqSize
+    // EFFECT: return the pointer that points to new added node
+    // Runtime: O(1)
+    Node* addNode(const TYPE& val) {
+        Node* newNode = this->nodes.create(val);
+        this->insertRoot(newNode);
+        return newNode;
+    } // addNode()
+
+private:
+    // the most extreme root, any node of the root list
+    Node* root;
+    std::size_t pqSize;
+    NodeStore<Node> nodes;
+    // roots by degree while pop() links them, kept to reuse its memory
+    std::vector<Node*> byDegree;
+    // COMP_FUNCTOR compare
+
+    // MODIFY: destroy every node, the memory is released by the node store
+    void destroyNodes(){
+        if(this->root == nullptr) return;
+        this->flatten();
+        Node* currNode = this->root;
+        do{
+            Node* next = currNode->right;
+            currNode->~Node();
+            currNode = next;
+        } while(currNode != this->root);
+        this->root = nullptr;
+    }
+
+
+    // REQUIRE: list is a node of a circular list other than the root list
+    // MODIFY: insert the whole list into the root list
+    void spliceRoots(Node* list){
+        Node* rootRight = this->root->right;
+        Node* listLeft = list->left;
+        this->root->right = list;
+        list->left = this->root;
+        listLeft->right = rootRight;
+        rootRight->left = listLeft;
+    }
+
+    // REQUIRE: node is not in the heap
+    // MODIFY: add node as a single node tree to the root list, update root and pqSize
+    void insertRoot(Node* node){
+        node->parent = node->child = nullptr;
+        node->left = node->right = node;
+        node->degree = 0;
+        node->marked = false;
+        if(this->root == nullptr) this->root = node;
+        else{
+            this->spliceRoots(node);
+            if(this->compare(this->root->elt, node->elt)) this->root = node;
+        }
+        this->pqSize++;
+    }
+
+    // MODIFY: take node out of the circular list it is in
+    static void unlink(Node* node){
+        node->left->right = node->right;
+        node->right->left = node->left;
+        node->left = node->right = node;
+    }
+
+    // REQUIRE: node has a parent
+    // MODIFY: move node, together with its children, from its parent to the root list
+    void cut(Node* node){
+        Node* parent = node->parent;
+        if(parent->child == node) parent->child = (node->right == node) ? nullptr : node->right;
+        unlink(node);
+        parent->degree--;
+        node->parent = nullptr;
+        node->marked = false;
+        this->spliceRoots(node);
+    }
+
+    // MODIFY: mark node for the child it lost, or cut it too if it had already
+    //         lost one, and so on up the tree
+    void cascadingCut(Node* node){
+        while(node->parent != nullptr){
+            if(!node->marked){
+                node->marked = true;
+                return;
+            }
+            Node* parent = node->parent;
+            this->cut(node);
+            node = parent;
+        }
+    }
+
+    // REQUIRE: node is in this pq
+    // MODIFY: take node out of the heap and update pqSize, node is not destroyed
+    void extract(Node* node){
+        if(node->parent != nullptr){
+            Node* parent = node->parent;
+            this->cut(node);
+            this->cascadingCut(parent);
+        }
+        // removeRoot() does not look at the root's value before it is gone
+        this->root = node;
+        this->removeRoot();
+    }
+
+    // REQUIRE: the heap is not empty
+    // MODIFY: take the root out of the heap, move its children to the root list
+    //         and link roots of the same degree, then find the new root
+    // EFFECT: return the removed node
+    Node* removeRoot(){
+        Node* removed = this->root;
+        Node* child = removed->child;
+        if(child != nullptr){
+            Node* currNode = child;
+            do{
+                currNode->parent = nullptr;
+                currNode->marked = false;
+                currNode = currNode->right;
+            } while(currNode != child);
+            this->spliceRoots(child);
+            removed->child = nullptr;
+        }
+        Node* rest = (removed->right == removed) ? nullptr : removed->right;
+        unlink(removed);
+        this->pqSize--;
+        this->root = nullptr;
+        if(rest != nullptr) this->consolidate(rest);
+        return removed;
+    }
+
+    // REQUIRE: loser is a root that is not more extreme than winner
+    // MODIFY: make loser a child of winner
+    void link(Node* winner, Node* loser){
+        loser->parent = winner;
+        loser->marked = false;
+        if(winner->child == nullptr) winner->child = loser;
+        else{
+            Node* childRight = winner->child->right;
+            winner->child->right = loser;
+            loser->left = winner->child;
+            loser->right = childRight;
+            childRight->left = loser;
+        }
+        winner->degree++;
+    }
+
+    // REQUIRE: first is a node of the root list, root is nullptr
+    // MODIFY: link roots of the same degree until all degrees differ, and
+    //         rebuild the root list out of what is left
+    void consolidate(Node* first){
+        // open the circle so the walk knows where to stop
+        first->left->right = nullptr;
+        Node* currNode = first;
+        while(currNode != nullptr){
+            Node* next = currNode->right;
+            currNode->left = currNode->right = currNode;
+            std::size_t degree = currNode->degree;
+            while(degree < this->byDegree.size() && this->byDegree[degree] != nullptr){
+                Node* other = this->byDegree[degree];
+                this->byDegree[degree] = nullptr;
+                if(this->compare(currNode->elt, other->elt)) std::swap(currNode, other);
+                this->link(currNode, other);
+                ++degree;
+            }
+            if(degree >= this->byDegree.size()) this->byDegree.resize(degree + 1, nullptr);
+            this->byDegree[degree] = currNode;
+            currNode = next;
+        }
+        for(Node*& slot : this->byDegree){
+            if(slot == nullptr) continue;
+            if(this->root == nullptr) this->root = slot;
+            else{
+                this->spliceRoots(slot);
+                if(this->compare(this->root->elt, slot->elt)) this->root = slot;
+            }
+            slot = nullptr;
+        }
+    }
+
+    // REQUIRE: the heap is not empty
+    // MODIFY: turn every node into a single node tree in the root list. The
+    //         root pointer stays on some node of that list
+    void flatten(){
+        // the children of each root are put right after it, so the walk
+        // around the growing root list reaches them before it is back
+        Node* currNode = this->root;
+        do{
+            Node* child = currNode->child;
+            if(child != nullptr){
+                Node* walk = child;
+                do{
+                    walk->parent = nullptr;
+                    walk = walk->right;
+                } while(walk != child);
+                Node* currRight = currNode->right;
+                Node* childLeft = child->left;
+                currNode->right = child;
+                child->left = currNode;
+                childLeft->right = currRight;
+                currRight->left = childLeft;
+                currNode->child = nullptr;
+            }
+            currNode->degree = 0;
+            currNode->marked = false;
+            currNode = currNode->right;
+        } while(currNode != this->root);
+    }
+}; // FibonacciPQ
+
+
+#endif // FIBONACCIPQ_H
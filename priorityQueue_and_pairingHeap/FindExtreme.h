@@ -0,0 +1,208 @@
+// Project identifier: 0E04A31E0D60C01986ACB20081C9D8722A1899B6
+
+#ifndef FINDEXTREME_H
+#define FINDEXTREME_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FIND_EXTREME_AVX2 1
+#include <immintrin.h>
+#endif
+
+
+// Linear search for the most extreme element of an unsorted vector, shared by
+// UnorderedPQ and UnorderedFastPQ.
+//
+// ExtremeFinder<TYPE, COMP_FUNCTOR>::find() returns the index of the first
+// element that no other element beats, i.e. the same index as the loop
+//
+//     for (size_t i = 1; i < data.size(); ++i)
+//         if (compare(data[index], data[i])) index = i;
+//
+// For int, float and double with std::less or std::greater the search is done
+// with AVX2 when the CPU has it: one pass takes the max (or min) of 8 ints or
+// floats, or 4 doubles, at a time, and a second pass finds the first element
+// equal to it. Every other TYPE and comparator uses the loop above.
+
+// REQUIRE: data is not empty
+// EFFECT: return the index of the first most extreme element, one by one
+template<typename TYPE, typename COMP_FUNCTOR>
+std::size_t scalarFindExtreme(const std::vector<TYPE>& data, const COMP_FUNCTOR& compare) {
+    std::size_t index = 0;
+
+    for (std::size_t i = 1; i < data.size(); ++i)
+        if (compare(data[index], data[i]))
+            index = i;
+
+    return index;
+}
+
+template<typename TYPE, typename COMP_FUNCTOR>
+struct ExtremeFinder {
+    // REQUIRE: data is not empty
+    static std::size_t find(const std::vector<TYPE>& data, const COMP_FUNCTOR& compare) {
+        return scalarFindExtreme(data, compare);
+    }
+};
+
+
+#if defined(FIND_EXTREME_AVX2)
+
+// The AVX2 instructions used for each element type.
+template<typename TYPE>
+struct SimdOps;
+
+template<>
+struct SimdOps<int> {
+    using Vec = __m256i;
+    static const std::size_t WIDTH = 8;
+
+    __attribute__((target("avx2"))) static Vec load(const int* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    __attribute__((target("avx2"))) static void store(int* p, Vec v) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+    __attribute__((target("avx2"))) static Vec broadcast(int x) { return _mm256_set1_epi32(x); }
+    __attribute__((target("avx2"))) static Vec max(Vec a, Vec b) { return _mm256_max_epi32(a, b); }
+    __attribute__((target("avx2"))) static Vec min(Vec a, Vec b) { return _mm256_min_epi32(a, b); }
+    // EFFECT: bit i is set if lane i of a equals lane i of b
+    __attribute__((target("avx2"))) static int equalMask(Vec a, Vec b) {
+        return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)));
+    }
+    // EFFECT: add the lanes of v that are NaN to the lanes set in nans
+    __attribute__((target("avx2"))) static Vec addNans(Vec nans, Vec) { return nans; }
+    __attribute__((target("avx2"))) static bool anyNan(Vec) { return false; }
+};
+
+template<>
+struct SimdOps<float> {
+    using Vec = __m256;
+    static const std::size_t WIDTH = 8;
+
+    __attribute__((target("avx2"))) static Vec load(const float* p) { return _mm256_loadu_ps(p); }
+    __attribute__((target("avx2"))) static void store(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+    __attribute__((target("avx2"))) static Vec broadcast(float x) { return _mm256_set1_ps(x); }
+    __attribute__((target("avx2"))) static Vec max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+    __attribute__((target("avx2"))) static Vec min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+    __attribute__((target("avx2"))) static int equalMask(Vec a, Vec b) {
+        return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ));
+    }
+    __attribute__((target("avx2"))) static Vec addNans(Vec nans, Vec v) {
+        return _mm256_or_ps(nans, _mm256_cmp_ps(v, v, _CMP_UNORD_Q));
+    }
+    __attribute__((target("avx2"))) static bool anyNan(Vec nans) { return _mm256_movemask_ps(nans) != 0; }
+};
+
+template<>
+struct SimdOps<double> {
+    using Vec = __m256d;
+    static const std::size_t WIDTH = 4;
+
+    __attribute__((target("avx2"))) static Vec load(const double* p) { return _mm256_loadu_pd(p); }
+    __attribute__((target("avx2"))) static void store(double* p, Vec v) { _mm256_storeu_pd(p, v); }
+    __attribute__((target("avx2"))) static Vec broadcast(double x) { return _mm256_set1_pd(x); }
+    __attribute__((target("avx2"))) static Vec max(Vec a, Vec b) { return _mm256_max_pd(a, b); }
+    __attribute__((target("avx2"))) static Vec min(Vec a, Vec b) { return _mm256_min_pd(a, b); }
+    __attribute__((target("avx2"))) static int equalMask(Vec a, Vec b) {
+        return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ));
+    }
+    __attribute__((target("avx2"))) static Vec addNans(Vec nans, Vec v) {
+        return _mm256_or_pd(nans, _mm256_cmp_pd(v, v, _CMP_UNORD_Q));
+    }
+    __attribute__((target("avx2"))) static bool anyNan(Vec nans) { return _mm256_movemask_pd(nans) != 0; }
+};
+
+
+// find() for arithmetic TYPE, FIND_MAX is true for std::less (the largest
+// element is the most extreme one) and false for std::greater.
+template<typename TYPE, typename COMP_FUNCTOR, bool FIND_MAX>
+struct SimdExtremeFinder {
+    using Ops = SimdOps<TYPE>;
+
+    // REQUIRE: data is not empty
+    static std::size_t find(const std::vector<TYPE>& data, const COMP_FUNCTOR& compare) {
+        // short vectors are not worth the two passes
+        if (data.size() < 4 * Ops::WIDTH || !hasAvx2())
+            return scalarFindExtreme(data, compare);
+
+        std::size_t index = findAvx2(data.data(), data.size());
+        // NaNs compare false with everything, they need the exact loop
+        if (index == data.size())
+            return scalarFindExtreme(data, compare);
+        return index;
+    }
+
+private:
+    static bool hasAvx2() {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+
+    static TYPE better(TYPE a, TYPE b) {
+        return (FIND_MAX ? a < b : b < a) ? b : a;
+    }
+
+    // EFFECT: return the index of the first most extreme element of
+    //         data[0, size), or size if there is a NaN
+    __attribute__((target("avx2")))
+    static std::size_t findAvx2(const TYPE* data, std::size_t size) {
+        const std::size_t width = Ops::WIDTH;
+
+        // first pass: lane-wise extreme of all full vectors
+        typename Ops::Vec extreme = Ops::load(data);
+        typename Ops::Vec nans = Ops::addNans(Ops::broadcast(TYPE()), extreme);
+        std::size_t i = width;
+        for (; i + width <= size; i += width) {
+            typename Ops::Vec next = Ops::load(data + i);
+            extreme = FIND_MAX ? Ops::max(extreme, next) : Ops::min(extreme, next);
+            nans = Ops::addNans(nans, next);
+        }
+        if (Ops::anyNan(nans))
+            return size;
+
+        TYPE lanes[width];
+        Ops::store(lanes, extreme);
+        TYPE value = lanes[0];
+        for (std::size_t lane = 1; lane < width; ++lane)
+            value = better(value, lanes[lane]);
+        for (; i < size; ++i) {
+            if (!(data[i] == data[i]))
+                return size;
+            value = better(value, data[i]);
+        }
+
+        // second pass: recover the index of the first element equal to it
+        typename Ops::Vec target = Ops::broadcast(value);
+        for (i = 0; i + width <= size; i += width) {
+            int mask = Ops::equalMask(Ops::load(data + i), target);
+            if (mask != 0)
+                return i + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+        }
+        for (; i < size; ++i)
+            if (data[i] == value)
+                return i;
+        return size;
+    }
+};
+
+
+template<>
+struct ExtremeFinder<int, std::less<int>> : SimdExtremeFinder<int, std::less<int>, true> {};
+template<>
+struct ExtremeFinder<int, std::greater<int>> : SimdExtremeFinder<int, std::greater<int>, false> {};
+template<>
+struct ExtremeFinder<float, std::less<float>> : SimdExtremeFinder<float, std::less<float>, true> {};
+template<>
+struct ExtremeFinder<float, std::greater<float>> : SimdExtremeFinder<float, std::greater<float>, false> {};
+template<>
+struct ExtremeFinder<double, std::less<double>> : SimdExtremeFinder<double, std::less<double>, true> {};
+template<>
+struct ExtremeFinder<double, std::greater<double>> : SimdExtremeFinder<double, std::greater<double>, false> {};
+
+#endif // FIND_EXTREME_AVX2
+
+#endif // FINDEXTREME_H
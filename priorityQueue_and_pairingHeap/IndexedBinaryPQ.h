@@ -0,0 +1,249 @@
+// Project identifier: 0E04A31E0D60C01986ACB20081C9D8722A1899B6
+
+#ifndef INDEXEDBINARYPQ_H
+#define INDEXEDBINARYPQ_H
+
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include "Eecs281PQ.h"
+
+// A binary heap that hands out a stable handle for every element it holds.
+// A handle stays valid until its element is popped or erased, no matter how
+// the element moves inside the heap, so a single element can be found again
+// and given a new priority in O(log(n)) without rebuilding the whole heap.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+class IndexedBinaryPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+    // Identifies one element of the heap, returned by addElt().
+    using Handle = std::size_t;
+
+
+    // Description: Construct an empty heap with an optional comparison functor.
+    // Runtime: O(1)
+    explicit IndexedBinaryPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp } {
+    } // IndexedBinaryPQ
+
+
+    // Description: Construct a heap out of an iterator range with an optional
+    //              comparison functor. The elements get the handles 0, 1, 2...
+    //              in the order of the range.
+    // Runtime: O(n) where n is number of elements in range.
+    template<typename InputIterator>
+    IndexedBinaryPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp }, data(start, end) {
+        for(std::size_t i = 0; i < this->data.size(); ++i){
+            this->handles.push_back(i);
+            this->positions.push_back(i + 1);
+        }
+        this->updatePriorities();
+    } // IndexedBinaryPQ
+
+
+    // Description: Destructor doesn't need any code, the vectors will
+    //              be destroyed automaticslly.
+    ~IndexedBinaryPQ() override {
+    } // ~IndexedBinaryPQ()
+
+
+    // Description: Assumes that all elements inside the heap are out of order and
+    //              'rebuilds' the heap by fixing the heap invariant. Handles
+    //              are kept.
+    // Runtime: O(n)
+    void updatePriorities() override{
+        // start from the first internal node
+        std::size_t i = this->data.size() / 2;
+        while(i >= 1){
+            this->fixDown(i);
+            --i;
+        }
+    } // updatePriorities()
+
+
+    // Description: Add a new element to the heap.
+    // Runtime: O(log(n))
+    void push(const TYPE & val) override{
+        this->addElt(val);
+    } // push()
+
+
+    // Description: Remove the most extreme (defined by 'compare') element from
+    //              the heap, its handle becomes invalid.
+    // Runtime: O(log(n))
+    void pop() override {
+        this->erase(this->handles[0]);
+    } // pop()
+
+
+    // Description: Return the most extreme (defined by 'compare') element of
+    //              the heap.
+    // Runtime: O(1)
+    const TYPE & top() const override{
+        return this->getByIndex(1);
+    } // top()
+
+
+    // Description: Return the handle of the most extreme element.
+    // Runtime: O(1)
+    Handle topHandle() const {
+        return this->handles[0];
+    } // topHandle()
+
+
+    // Description: Get the number of elements in the heap.
+    // Runtime: O(1)
+    std::size_t size() const override {
+        return this->data.size();
+    } // size()
+
+
+    // Description: Return true if the heap is empty.
+    // Runtime: O(1)
+    bool empty() const override {
+        return this->data.empty();
+    } // empty()
+
+
+    // MODIFY: insert the new element
+    // EFFECT: return the handle of the new element, handles of popped or
+    //         erased elements are reused
+    // Runtime: O(log(n))
+    Handle addElt(const TYPE& val) {
+        Handle handle;
+        if(this->freeHandles.empty()){
+            handle = this->positions.size();
+            this->positions.push_back(0);
+        }
+        else{
+            handle = this->freeHandles.back();
+            this->freeHandles.pop_back();
+        }
+        this->data.push_back(val);
+        this->handles.push_back(handle);
+        this->positions[handle] = this->data.size();
+        this->fixUp(this->data.size());
+        return handle;
+    } // addElt()
+
+
+    // REQUIRE: handle refers to an element in this pq
+    // EFFECT: return the element referenced by handle
+    // Runtime: O(1)
+    const TYPE& getElt(Handle handle) const {
+        return this->getByIndex(this->positions[handle]);
+    } // getElt()
+
+
+    // EFFECT: return true if handle refers to an element in this pq
+    // Runtime: O(1)
+    bool contains(Handle handle) const {
+        return handle < this->positions.size() && this->positions[handle] != 0;
+    } // contains()
+
+
+    // REQUIRE: handle refers to an element in this pq
+    // MODIFY: replace the element referenced by handle with new_value, which
+    //         may be larger or smaller than the old one, and move it to its
+    //         new place in the heap
+    // Runtime: O(log(n))
+    void updateElt(Handle handle, const TYPE & new_value) {
+        std::size_t index = this->positions[handle];
+        this->getByIndex(index) = new_value;
+        this->fixAt(index);
+    } // updateElt()
+
+
+    // REQUIRE: handle refers to an element in this pq
+    // MODIFY: remove the element referenced by handle, the handle becomes
+    //         invalid
+    // Runtime: O(log(n))
+    void erase(Handle handle) {
+        std::size_t index = this->positions[handle];
+        std::size_t last = this->data.size();
+        this->swapByIndex(index, last);
+        this->data.pop_back();
+        this->handles.pop_back();
+        this->positions[handle] = 0;
+        this->freeHandles.push_back(handle);
+        if(index < last) this->fixAt(index);
+    } // erase()
+
+
+private:
+    // Note: This vector *must* be used your heap implementation.
+    std::vector<TYPE> data;
+    // handles[i - 1] is the handle of the element at index i
+    std::vector<Handle> handles;
+    // positions[handle] is the index of the element, 0 if the handle is free
+    std::vector<std::size_t> positions;
+    // handles that can be given out again by addElt()
+    std::vector<Handle> freeHandles;
+    // COMP_FUNCTOR comp; (base class)
+
+    // REQUIRE: index >= 1 && index <= size of vector
+    // EFFECT: get element reference by index
+    TYPE& getByIndex(std::size_t index){
+        return this->data[index - 1];
+    }
+    const TYPE& getByIndex(std::size_t index) const{
+        return this->data[index - 1];
+    }
+
+    //REQUIRE:  1 <= index <= size of vector
+    //MODIFY: swap the elements in specified index and keep positions up to date
+    void swapByIndex(std::size_t index1, std::size_t index2){
+        std::swap(this->data[index1 - 1], this->data[index2 - 1]);
+        std::swap(this->handles[index1 - 1], this->handles[index2 - 1]);
+        this->positions[this->handles[index1 - 1]] = index1;
+        this->positions[this->handles[index2 - 1]] = index2;
+    }
+
+    // REQUIRE: 1 <= index <= size of vector
+    // MODIFY: move the element at index up or down, whichever it needs
+    void fixAt(std::size_t index){
+        if(index != 1 && this->compare(this->getByIndex(index / 2), this->getByIndex(index))){
+            this->fixUp(index);
+        }
+        else this->fixDown(index);
+    }
+
+    // REQUIRE: index is location on where we change an element
+    // MODIFY: fix up the data vector to build a valid heap
+    void fixUp(std::size_t index){
+        while(index != 1){
+            // if its parent is smaller than it
+            if(this->compare(this->getByIndex(index / 2), this->getByIndex(index))){
+                this->swapByIndex(index, index/2);
+            }
+            else break;
+            index = index / 2;
+        }
+    }
+
+    void fixDown(std::size_t index){
+        // until we reach the leaf node
+        while(index <= this->data.size() / 2){
+            std::size_t childIndex = index * 2;
+            // if we have two child and the right child is larger than left child
+            if(childIndex < this->data.size() &&
+                this->compare(this->getByIndex(childIndex), this->getByIndex(childIndex + 1))){
+                ++childIndex;
+            }
+            // if this element if smaller than his child
+            if(this->compare(this->getByIndex(index), this->getByIndex(childIndex))){
+                this->swapByIndex(index, childIndex);
+            }
+            else break;
+            index = childIndex;
+        }
+    }
+
+}; // IndexedBinaryPQ
+
+
+#endif // INDEXEDBINARYPQ_H
@@ -0,0 +1,282 @@
+// Project identifier: 0E04A31E0D60C01986ACB20081C9D8722A1899B6
+
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include "Eecs281PQ.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+// Counting of comparator calls and element copies and moves, for the
+// priority queues and the sorting algorithms, without touching their code:
+//
+//   CountingComp<COMP>  wraps a comparison functor and counts its calls
+//   Counted<TYPE>       wraps an element and counts its copies, moves and
+//                       operator< calls (so std::less<Counted<TYPE>> counts)
+//   InstrumentedPQ<PQ>  wraps any Eecs281PQ and books what each call costs
+//                       under the name of the operation, "push", "pop", ...
+//
+// The counts go to the operation named by the innermost live
+// InstrumentStats::Scope, or to "other" if there is none, so a sort can be
+// measured with
+//
+//     InstrumentStats::global().reset();
+//     {
+//         InstrumentStats::Scope scope("quickSort");
+//         quickSort(v.begin(), v.end(), CountingComp<std::less<int>>());
+//     }
+//     InstrumentStats::global().report(stdout);
+//
+// Use either CountingComp or Counted for one heap or sort, not both, or every
+// comparison is counted twice. The counters are not synchronized, only one
+// thread may use counted elements or comparators at a time.
+
+// The counts of one kind of operation.
+struct OpStats {
+    const char* name;
+    std::uint64_t calls;
+    std::uint64_t compares;
+    std::uint64_t copies;
+    std::uint64_t moves;
+};
+
+
+class InstrumentStats {
+public:
+    // Description: The stats that all counting wrappers report to.
+    static InstrumentStats& global() {
+        static InstrumentStats stats;
+        return stats;
+    } // global()
+
+
+    // Names the operation the counts go to while it is alive. Scopes nest,
+    // the innermost one wins.
+    class Scope {
+    public:
+        explicit Scope(const char* op) : previous{ global().current } {
+            InstrumentStats& stats = global();
+            stats.current = stats.find(op);
+            stats.ops[stats.current].calls++;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        ~Scope() {
+            global().current = this->previous;
+        }
+
+    private:
+        std::size_t previous;
+    }; // Scope
+
+
+    // Description: Forget all counts.
+    // Runtime: O(number of operation names)
+    void reset() {
+        this->ops.clear();
+        this->ops.push_back(OpStats{ "other", 0, 0, 0, 0 });
+        this->current = 0;
+    } // reset()
+
+    void countCompare() { this->ops[this->current].compares++; }
+    void countCopy() { this->ops[this->current].copies++; }
+    void countMove() { this->ops[this->current].moves++; }
+
+
+    // Description: Return the counts of one operation, all zero if it never ran.
+    // Runtime: O(number of operation names)
+    OpStats get(const char* op) const {
+        for(const OpStats& stats : this->ops){
+            if(std::strcmp(stats.name, op) == 0) return stats;
+        }
+        return OpStats{ op, 0, 0, 0, 0 };
+    } // get()
+
+
+    // Description: Return the sum of the counts of all operations.
+    // Runtime: O(number of operation names)
+    OpStats total() const {
+        OpStats sum{ "total", 0, 0, 0, 0 };
+        for(const OpStats& stats : this->ops){
+            sum.calls += stats.calls;
+            sum.compares += stats.compares;
+            sum.copies += stats.copies;
+            sum.moves += stats.moves;
+        }
+        return sum;
+    } // total()
+
+
+    // Description: Print one line per operation that counted anything, with
+    //              the counts per call, and a total line.
+    // Runtime: O(number of operation names)
+    void report(std::FILE* out) const {
+        std::fprintf(out, "%-20s %12s %14s %10s %14s %14s\n", "operation", "calls",
+                     "compares", "cmp/call", "copies", "moves");
+        for(const OpStats& stats : this->ops){
+            if(stats.calls + stats.compares + stats.copies + stats.moves == 0) continue;
+            this->reportLine(out, stats);
+        }
+        this->reportLine(out, this->total());
+    } // report()
+
+private:
+    std::vector<OpStats> ops;
+    // index in ops of the operation that counts go to now
+    std::size_t current;
+
+    InstrumentStats() {
+        this->reset();
+    }
+
+    // EFFECT: return the index of op in ops, adding it if it is new
+    std::size_t find(const char* op) {
+        for(std::size_t i = 0; i < this->ops.size(); ++i){
+            if(std::strcmp(this->ops[i].name, op) == 0) return i;
+        }
+        this->ops.push_back(OpStats{ op, 0, 0, 0, 0 });
+        return this->ops.size() - 1;
+    }
+
+    static void reportLine(std::FILE* out, const OpStats& stats) {
+        double perCall = (stats.calls == 0) ? 0.0
+            : static_cast<double>(stats.compares) / static_cast<double>(stats.calls);
+        std::fprintf(out, "%-20s %12llu %14llu %10.2f %14llu %14llu\n", stats.name,
+                     static_cast<unsigned long long>(stats.calls),
+                     static_cast<unsigned long long>(stats.compares), perCall,
+                     static_cast<unsigned long long>(stats.copies),
+                     static_cast<unsigned long long>(stats.moves));
+    }
+}; // InstrumentStats
+
+
+// A comparison functor that counts its calls and then asks COMP_FUNCTOR.
+template<typename COMP_FUNCTOR>
+struct CountingComp {
+    COMP_FUNCTOR comp;
+
+    template<typename T>
+    bool operator()(const T& a, const T& b) const {
+        InstrumentStats::global().countCompare();
+        return comp(a, b);
+    }
+};
+
+
+// An element that counts how often it is copied, moved and compared.
+template<typename TYPE>
+class Counted {
+public:
+    Counted() : value() {}
+    Counted(const TYPE& val) : value(val) {}
+
+    Counted(const Counted& other) : value(other.value) {
+        InstrumentStats::global().countCopy();
+    }
+    // Moves are noexcept when TYPE's are, so that vector reallocation moves
+    // Counted elements instead of copying them, as it does for TYPE itself.
+    Counted(Counted&& other) noexcept(std::is_nothrow_move_constructible<TYPE>::value) :
+        value(std::move(other.value)) {
+        InstrumentStats::global().countMove();
+    }
+    Counted& operator=(const Counted& other) {
+        InstrumentStats::global().countCopy();
+        this->value = other.value;
+        return *this;
+    }
+    Counted& operator=(Counted&& other) noexcept(std::is_nothrow_move_assignable<TYPE>::value) {
+        InstrumentStats::global().countMove();
+        this->value = std::move(other.value);
+        return *this;
+    }
+
+    const TYPE& get() const { return this->value; }
+
+    friend bool operator<(const Counted& a, const Counted& b) {
+        InstrumentStats::global().countCompare();
+        return a.value < b.value;
+    }
+    friend bool operator>(const Counted& a, const Counted& b) {
+        return b < a;
+    }
+    // equality is for checking results and is not counted
+    friend bool operator==(const Counted& a, const Counted& b) {
+        return a.value == b.value;
+    }
+
+private:
+    TYPE value;
+};
+
+
+// A priority queue that forwards every call to a PQ it owns and books the
+// comparisons, copies and moves the call caused under the call's name.
+template<typename PQ>
+class InstrumentedPQ final : public Eecs281PQ<typename PQ::value_type, typename PQ::compare_type> {
+    using TYPE = typename PQ::value_type;
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281PQ<TYPE, typename PQ::compare_type>;
+
+public:
+    // Description: Construct the wrapped PQ from any constructor arguments.
+    // Runtime: the runtime of PQ's constructor
+    template<typename... Args>
+    explicit InstrumentedPQ(Args&&... args) : pq(makePQ(std::forward<Args>(args)...)) {
+    } // InstrumentedPQ()
+
+    ~InstrumentedPQ() override {
+    } // ~InstrumentedPQ()
+
+    void push(const TYPE& val) override {
+        InstrumentStats::Scope scope("push");
+        this->pq.push(val);
+    } // push()
+
+    void pop() override {
+        InstrumentStats::Scope scope("pop");
+        this->pq.pop();
+    } // pop()
+
+    const TYPE& top() const override {
+        InstrumentStats::Scope scope("top");
+        return this->pq.top();
+    } // top()
+
+    std::size_t size() const override {
+        return this->pq.size();
+    } // size()
+
+    bool empty() const override {
+        return this->pq.empty();
+    } // empty()
+
+    void updatePriorities() override {
+        InstrumentStats::Scope scope("updatePriorities");
+        this->pq.updatePriorities();
+    } // updatePriorities()
+
+    // Description: Access the wrapped PQ for calls that are not part of
+    //              Eecs281PQ. They are counted under "other" or a scope of
+    //              the caller.
+    PQ& inner() {
+        return this->pq;
+    } // inner()
+
+private:
+    PQ pq;
+
+    template<typename... Args>
+    static PQ makePQ(Args&&... args) {
+        InstrumentStats::Scope scope("construct");
+        return PQ(std::forward<Args>(args)...);
+    }
+}; // InstrumentedPQ
+
+#endif // INSTRUMENT_H
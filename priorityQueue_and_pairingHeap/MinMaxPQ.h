@@ -0,0 +1,226 @@
+// Project identifier: 0E04A31E0D60C01986ACB20081C9D8722A1899B6
+
+#ifndef MINMAXPQ_H
+#define MINMAXPQ_H
+
+#include "Eecs281PQ.h"
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+// A double-ended priority queue implemented as a min-max heap in one vector.
+// 'compare' has the same meaning as in BinaryPQ: with std::less the largest
+// element is the most extreme one, top_max(), and the smallest one is the
+// least extreme, top_min(). Through the Eecs281PQ interface top() and pop()
+// work on the most extreme end.
+//
+// Nodes on even levels (the root is on level 0) are more extreme than all
+// their descendants, nodes on odd levels are less extreme than all of theirs.
+// So the most extreme element is the root and the least extreme one is one of
+// the root's children.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+class MinMaxPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+    // Description: Construct an empty heap with an optional comparison functor.
+    // Runtime: O(1)
+    explicit MinMaxPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp } {
+    } // MinMaxPQ
+
+
+    // Description: Construct a heap out of an iterator range with an optional
+    //              comparison functor.
+    // Runtime: O(n) where n is number of elements in range.
+    template<typename InputIterator>
+    MinMaxPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp }, data(start, end) {
+        this->updatePriorities();
+    } // MinMaxPQ
+
+
+    // Description: Destructor doesn't need any code, the data vector will
+    //              be destroyed automaticslly.
+    ~MinMaxPQ() override {
+    } // ~MinMaxPQ()
+
+
+    // Description: Assumes that all elements inside the heap are out of order and
+    //              'rebuilds' the heap by fixing the heap invariant.
+    // Runtime: O(n)
+    void updatePriorities() override {
+        // start from the last internal node
+        std::size_t i = this->data.size() / 2;
+        while(i >= 1){
+            this->fixDown(i);
+            --i;
+        }
+    } // updatePriorities()
+
+
+    // Description: Add a new element to the heap.
+    // Runtime: O(log(n))
+    void push(const TYPE & val) override {
+        this->data.push_back(val);
+        this->fixUp(this->data.size());
+    } // push()
+
+
+    // Description: Remove the most extreme element, same as pop_max().
+    // Runtime: O(log(n))
+    void pop() override {
+        this->pop_max();
+    } // pop()
+
+
+    // Description: Return the most extreme element, same as top_max().
+    // Runtime: O(1)
+    const TYPE & top() const override {
+        return this->top_max();
+    } // top()
+
+
+    // Description: Return the most extreme (defined by 'compare') element.
+    // Runtime: O(1)
+    const TYPE & top_max() const {
+        return this->getByIndex(1);
+    } // top_max()
+
+
+    // Description: Return the least extreme (defined by 'compare') element.
+    // Runtime: O(1)
+    const TYPE & top_min() const {
+        return this->getByIndex(this->minIndex());
+    } // top_min()
+
+
+    // Description: Remove the most extreme element.
+    // Runtime: O(log(n))
+    void pop_max() {
+        this->removeAt(1);
+    } // pop_max()
+
+
+    // Description: Remove the least extreme element.
+    // Runtime: O(log(n))
+    void pop_min() {
+        this->removeAt(this->minIndex());
+    } // pop_min()
+
+
+    // Description: Get the number of elements in the heap.
+    // Runtime: O(1)
+    std::size_t size() const override {
+        return this->data.size();
+    } // size()
+
+
+    // Description: Return true if the heap is empty.
+    // Runtime: O(1)
+    bool empty() const override {
+        return this->data.empty();
+    } // empty()
+
+
+private:
+    // Note: This vector *must* be used your heap implementation.
+    std::vector<TYPE> data;
+    // COMP_FUNCTOR comp; (base class)
+
+    // REQUIRE: index >= 1 && index <= size of vector
+    // EFFECT: get element reference by index
+    TYPE& getByIndex(std::size_t index){
+        return this->data[index - 1];
+    }
+    const TYPE& getByIndex(std::size_t index) const{
+        return this->data[index - 1];
+    }
+
+    //REQUIRE:  1 <= index <= size of vector
+    //MODIFY: swap the elements in specified index
+    void swapByIndex(std::size_t index1, std::size_t index2){
+        std::swap(this->data[index1 - 1], this->data[index2 - 1]);
+    }
+
+    // EFFECT: return true if index is on a level of more extreme elements
+    static bool isMaxLevel(std::size_t index){
+        bool maxLevel = true;
+        while(index > 1){
+            index /= 2;
+            maxLevel = !maxLevel;
+        }
+        return maxLevel;
+    }
+
+    // EFFECT: return true if the element at index1 should be nearer to the
+    //         extreme that fixing for maxLevel goes to than the one at index2
+    bool before(std::size_t index1, std::size_t index2, bool maxLevel) const {
+        if(maxLevel) return this->compare(this->getByIndex(index2), this->getByIndex(index1));
+        return this->compare(this->getByIndex(index1), this->getByIndex(index2));
+    }
+
+    // REQUIRE: heap is not empty
+    // EFFECT: return the index of the least extreme element
+    std::size_t minIndex() const {
+        if(this->data.size() == 1) return 1;
+        if(this->data.size() == 2) return 2;
+        return this->compare(this->getByIndex(3), this->getByIndex(2)) ? 3 : 2;
+    }
+
+    // REQUIRE: 1 <= index <= size of vector
+    // MODIFY: replace the element at index with the last one and fix the heap
+    void removeAt(std::size_t index){
+        if(index != this->data.size()){
+            this->getByIndex(index) = std::move(this->data.back());
+            this->data.pop_back();
+            this->fixDown(index);
+        }
+        else this->data.pop_back();
+    }
+
+    // REQUIRE: index is location on where we add an element
+    // MODIFY: move it up among its grandparents on the right kind of level
+    void fixUp(std::size_t index){
+        if(index == 1) return;
+        bool maxLevel = this->isMaxLevel(index);
+        std::size_t parent = index / 2;
+        // if it belongs on the parent's kind of level, swap them first
+        if(this->before(parent, index, maxLevel)){
+            this->swapByIndex(index, parent);
+            index = parent;
+            maxLevel = !maxLevel;
+        }
+        while(index >= 4 && this->before(index, index / 4, maxLevel)){
+            this->swapByIndex(index, index / 4);
+            index /= 4;
+        }
+    }
+
+    // REQUIRE: 1 <= index <= size of vector
+    // MODIFY: move the element at index down among its grandchildren
+    void fixDown(std::size_t index){
+        bool maxLevel = this->isMaxLevel(index);
+        while(index * 2 <= this->data.size()){
+            // the best of the children and grandchildren for this kind of level
+            std::size_t best = index * 2;
+            if(best < this->data.size() && this->before(best + 1, best, maxLevel)) ++best;
+            std::size_t lastGrandchild = std::min(index * 4 + 3, this->data.size());
+            for(std::size_t i = index * 4; i <= lastGrandchild; ++i){
+                if(this->before(i, best, maxLevel)) best = i;
+            }
+            if(!this->before(best, index, maxLevel)) break;
+            this->swapByIndex(best, index);
+            // a child is on the other kind of level and has no children to fix
+            if(best < index * 4) break;
+            // the element that moved down may belong on its parent's level
+            if(this->before(best / 2, best, maxLevel)) this->swapByIndex(best, best / 2);
+            index = best;
+        }
+    }
+}; // MinMaxPQ
+
+#endif // MINMAXPQ_H
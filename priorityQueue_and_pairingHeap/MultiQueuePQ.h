@@ -0,0 +1,181 @@
+// Project identifier: 0E04A31E0D60C01986ACB20081C9D8722A1899B6
+
+#ifndef MULTIQUEUEPQ_H
+#define MULTIQUEUEPQ_H
+
+#include "BinaryPQ.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+// A relaxed priority queue that many threads can use at the same time, built
+// as a MultiQueue: c * p BinaryPQ shards, each behind its own mutex, for p
+// threads. push() goes to a random shard, and pop takes the better top of two
+// random shards. A popped element is not always the most extreme one in the
+// whole queue, but it is close to it, and threads rarely wait for each other
+// because they almost never pick the same shards.
+//
+// This is not an Eecs281PQ: top() can not hand out a reference that another
+// thread may pop at any moment, so the top is removed and returned together
+// by try_pop().
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+class MultiQueuePQ {
+public:
+    // Description: Construct an empty queue for up to threads threads, with
+    //              queuesPerThread shards per thread.
+    // Runtime: O(threads * queuesPerThread)
+    explicit MultiQueuePQ(std::size_t threads, std::size_t queuesPerThread = 2,
+                          COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        compare{ comp }, shardCount{ std::max<std::size_t>(1, threads * queuesPerThread) },
+        shards{ nullptr }, count{ 0 } {
+        // new only aligns to 16 bytes, the shards are placed in one block by hand
+        std::size_t space = this->shardCount * sizeof(Shard) + alignof(Shard);
+        this->shardMemory.reset(new char[space]);
+        void* memory = this->shardMemory.get();
+        this->shards = static_cast<Shard*>(std::align(alignof(Shard), this->shardCount * sizeof(Shard),
+                                                      memory, space));
+        std::size_t built = 0;
+        try{
+            for(; built < this->shardCount; ++built) new (this->shards + built) Shard(comp);
+        }
+        catch(...){
+            while(built > 0) this->shards[--built].~Shard();
+            throw;
+        }
+    } // MultiQueuePQ()
+
+    MultiQueuePQ(const MultiQueuePQ&) = delete;
+    MultiQueuePQ& operator=(const MultiQueuePQ&) = delete;
+
+    // Description: Destroy all shards and their elements.
+    // Runtime: O(n)
+    ~MultiQueuePQ() {
+        for(std::size_t i = 0; i < this->shardCount; ++i) this->shards[i].~Shard();
+    } // ~MultiQueuePQ()
+
+
+    // Description: Add a new element to a random shard. Safe to call from any
+    //              thread.
+    // Runtime: O(log(n / shards)) plus waiting for the lock
+    void push(const TYPE& val) {
+        TYPE copy(val);
+        this->push(std::move(copy));
+    } // push()
+
+    void push(TYPE&& val) {
+        Shard& shard = this->shards[this->randomShard()];
+        {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            shard.heap.push(std::move(val));
+        }
+        this->count.fetch_add(1, std::memory_order_relaxed);
+    } // push()
+
+
+    // Description: Remove an element close to the most extreme one and move it
+    //              into result. Safe to call from any thread.
+    // EFFECT: return false, and leave result alone, if the queue was empty
+    // Runtime: O(log(n / shards)) usually, O(shards) if the queue is nearly
+    //          empty or the tries all found busy shards
+    bool try_pop(TYPE& result) {
+        // a few relaxed tries on two random shards, skipping busy ones
+        for(std::size_t attempt = 0; attempt < 2 * this->shardCount; ++attempt){
+            if(this->count.load(std::memory_order_relaxed) == 0) break;
+            Shard& first = this->shards[this->randomShard()];
+            Shard& second = this->shards[this->randomShard()];
+            std::unique_lock<std::mutex> firstLock(first.lock, std::try_to_lock);
+            if(!firstLock.owns_lock()) continue;
+            std::unique_lock<std::mutex> secondLock;
+            if(&second != &first){
+                secondLock = std::unique_lock<std::mutex>(second.lock, std::try_to_lock);
+                if(!secondLock.owns_lock()) continue;
+            }
+            Shard* better = &first;
+            if(!second.heap.empty() &&
+               (first.heap.empty() || this->compare(first.heap.top(), second.heap.top()))){
+                better = &second;
+            }
+            if(better->heap.empty()) continue;
+            result = better->heap.pop_value();
+            this->count.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        // the queue is empty or nearly so, or busy: look at every shard before
+        // giving up, from a random one on so that threads get here spread
+        // out, and pop the best top seen. The best shard so far stays locked,
+        // if the next one is busy std::lock() waits for both without deadlock
+        std::size_t start = this->randomShard();
+        Shard* best = &this->shards[start];
+        std::unique_lock<std::mutex> bestLock(best->lock);
+        for(std::size_t i = 1; i < this->shardCount; ++i){
+            Shard& next = this->shards[(start + i) % this->shardCount];
+            std::unique_lock<std::mutex> nextLock(next.lock, std::try_to_lock);
+            if(!nextLock.owns_lock()){
+                bestLock.unlock();
+                std::lock(bestLock, nextLock);
+            }
+            if(!next.heap.empty() &&
+               (best->heap.empty() || this->compare(best->heap.top(), next.heap.top()))){
+                best = &next;
+                bestLock.swap(nextLock);
+            }
+        }
+        if(best->heap.empty()) return false;
+        result = best->heap.pop_value();
+        this->count.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    } // try_pop()
+
+
+    // Description: Get the number of elements, only exact when no other
+    //              thread is pushing or popping.
+    // Runtime: O(1)
+    std::size_t size() const {
+        return this->count.load(std::memory_order_relaxed);
+    } // size()
+
+
+    // Description: Return true if the queue is empty, only exact when no other
+    //              thread is pushing or popping.
+    // Runtime: O(1)
+    bool empty() const {
+        return this->size() == 0;
+    } // empty()
+
+
+private:
+    // One lock protected heap. Every shard starts a cache line and fills
+    // whole ones, so threads using neighbouring shards don't slow each other
+    // down.
+    struct alignas(64) Shard {
+        std::mutex lock;
+        BinaryPQ<TYPE, COMP_FUNCTOR> heap;
+
+        explicit Shard(const COMP_FUNCTOR& comp) : heap{ comp } {}
+    };
+
+    COMP_FUNCTOR compare;
+    std::size_t shardCount;
+    std::unique_ptr<char[]> shardMemory;
+    // shardCount shards in shardMemory
+    Shard* shards;
+    std::atomic<std::size_t> count;
+
+    // EFFECT: return a random shard index, every thread has its own generator
+    std::size_t randomShard() const {
+        thread_local std::minstd_rand generator(
+            static_cast<std::minstd_rand::result_type>(std::hash<std::thread::id>()(std::this_thread::get_id())));
+        return generator() % this->shardCount;
+    }
+}; // MultiQueuePQ
+
+#endif // MULTIQUEUEPQ_H
@@ -0,0 +1,113 @@
+// Project identifier: 0E04A31E0D60C01986ACB20081C9D8722A1899B6
+
+#ifndef NODESTORE_H
+#define NODESTORE_H
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+// Owns the memory of the nodes of a node based heap (PairingPQ, FibonacciPQ,
+// RankPairingPQ). Nodes are carved out of array blocks that are only released
+// when the store is destroyed, so nodes that are created together sit next to
+// each other in memory. A destroyed node goes into a free list and its memory
+// is reused by the next created node.
+//
+// The store does not know which of its slots hold live nodes, the heap must
+// destroy (or call the destructor of) every node it created before the store
+// itself goes away.
+template<typename NODE>
+class NodeStore {
+public:
+    NodeStore() : freeList{nullptr}, freeTail{nullptr}, nextSlot{nullptr},
+        slotsLeft{0}, capacity{0} {}
+
+    NodeStore(const NodeStore&) = delete;
+    NodeStore& operator=(const NodeStore&) = delete;
+
+    // MODIFY: start a new block with room for count nodes, the next
+    //         count calls to create() without free nodes fill it in order
+    void reserve(std::size_t count){
+        this->addBlock(count);
+    }
+
+    // EFFECT: construct a node from args and return it
+    template<typename... Args>
+    NODE* create(Args&&... args){
+        void* memory;
+        if(this->freeList != nullptr){
+            memory = this->freeList;
+            this->freeList = this->freeList->next;
+            if(this->freeList == nullptr) this->freeTail = nullptr;
+        }
+        else{
+            if(this->slotsLeft == 0) this->addBlock(this->capacity < 16 ? 16 : this->capacity);
+            memory = this->nextSlot++;
+            this->slotsLeft--;
+        }
+        return new (memory) NODE(std::forward<Args>(args)...);
+    }
+
+    // REQUIRE: node was created by this store
+    // MODIFY: destroy node and keep its memory for reuse
+    void destroy(NODE* node){
+        node->~NODE();
+        FreeSlot* slot = new (static_cast<void*>(node)) FreeSlot{ this->freeList };
+        if(this->freeList == nullptr) this->freeTail = slot;
+        this->freeList = slot;
+    }
+
+    // MODIFY: take over all memory of other, its nodes now belong to this
+    //         store. The unused rest of other's current block is dropped
+    void absorb(NodeStore& other){
+        this->blocks.splice(this->blocks.end(), other.blocks);
+        if(other.freeList != nullptr){
+            other.freeTail->next = this->freeList;
+            if(this->freeList == nullptr) this->freeTail = other.freeTail;
+            this->freeList = other.freeList;
+        }
+        this->capacity += other.capacity;
+        other.freeList = other.freeTail = nullptr;
+        other.nextSlot = nullptr;
+        other.slotsLeft = other.capacity = 0;
+    }
+
+    void swap(NodeStore& other){
+        std::swap(this->blocks, other.blocks);
+        std::swap(this->freeList, other.freeList);
+        std::swap(this->freeTail, other.freeTail);
+        std::swap(this->nextSlot, other.nextSlot);
+        std::swap(this->slotsLeft, other.slotsLeft);
+        std::swap(this->capacity, other.capacity);
+    }
+
+private:
+    using Slot = typename std::aligned_storage<sizeof(NODE), alignof(NODE)>::type;
+    // what is left in the memory of a destroyed node
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+    static_assert(sizeof(Slot) >= sizeof(FreeSlot), "a node must be able to hold a free list link");
+
+    std::list<std::unique_ptr<Slot[]>> blocks;
+    FreeSlot* freeList;
+    FreeSlot* freeTail;
+    // unused part of the newest block
+    Slot* nextSlot;
+    std::size_t slotsLeft;
+    // total number of slots in all blocks, new blocks double it
+    std::size_t capacity;
+
+    void addBlock(std::size_t count){
+        this->blocks.push_back(std::unique_ptr<Slot[]>(new Slot[count]));
+        this->nextSlot = this->blocks.back().get();
+        this->slotsLeft = count;
+        this->capacity += count;
+    }
+}; // NodeStore
+
+#endif // NODESTORE_H
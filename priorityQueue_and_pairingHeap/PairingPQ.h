@@ -4,12 +4,12 @@
 #define PAIRINGPQ_H
 
 #include "Eecs281PQ.h"
-#include <deque>
+#include "NodeStore.h"
 #include <utility>
 
 // A specialized version of the 'priority_queue' ADT implemented as a pairing heap.
 template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
-class PairingPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+class PairingPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
     // This is a way to refer to the base class object.
     using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
 
@@ -63,20 +63,27 @@ public:
     } // PairingPQ()
 
 
-    // Description: Copy constructor.
+    // Description: Copy constructor. The copy has exactly the same tree shape as
+    //              other, and all of its nodes are placed in one block of memory.
     // Runtime: O(n)
     PairingPQ(const PairingPQ& other): BaseClass{ other.compare }, root{nullptr}, pqSize{0}{
-        if(other.size() == 0) return;
-        else{
-            std::deque<Node*> table;
-            table.push_back(other.root);
-            while(!table.empty()){
-                Node* currNode = table.front();
-                table.pop_front();
-                if(currNode->child != nullptr) table.push_back(currNode->child);
-                if(currNode->sibling != nullptr) table.push_back(currNode->sibling);
-                this->addNode(currNode->elt);
-            } 
+        if(other.root == nullptr) return;
+        this->nodes.reserve(other.pqSize);
+        this->pqSize = other.pqSize;
+        // preorder walk over other that climbs back up through the previous
+        // pointers, so no container of pending nodes is needed. The copy is
+        // walked in lockstep, every node is linked to its copied previous
+        const Node* currNode = other.root;
+        Node* copyNode = this->nodes.create(currNode->elt);
+        this->root = copyNode;
+        // if copying an element throws, the nodes copied so far form a tree
+        // from root and are destroyed like in the destructor
+        try{
+            this->copyNodes(currNode, copyNode);
+        }
+        catch(...){
+            this->destroyNodes();
+            throw;
         }
     } // PairingPQ()
 
@@ -87,44 +94,42 @@ public:
         std::swap(this->root, temp.root);
         std::swap(this->pqSize, temp.pqSize);
         std::swap(this->compare, temp.compare);
+        this->nodes.swap(temp.nodes);
         return *this;
     } // operator=()
 
     // Description: Destructor
     // Runtime: O(n)
     ~PairingPQ() override{
-        if(this->pqSize == 0) return;
-        else{
-            std::deque<Node*> table;
-            table.push_back(this->root);
-            while(!table.empty()){
-                Node* currNode = table.front();
-                table.pop_front();
-                if(currNode->child != nullptr) table.push_back(currNode->child);
-                if(currNode->sibling != nullptr) table.push_back(currNode->sibling);
-                delete currNode;
-            }
-        }
+        this->destroyNodes();
     } // ~PairingPQ()
 
     // Description: Assumes that all elements inside the priority_queue are out of order and
     //              'rebuilds' the priority_queue by fixing the priority_queue invariant.
+    //              The nodes are reused, so pointers from addNode() stay valid.
     // Runtime: O(n)
     void updatePriorities() override {
         if(this->pqSize == 1 || this->pqSize == 0) return;
-        std::deque<Node*> table;
-        table.push_back(this->root);
-        this->root = nullptr;
-        this->pqSize = 0;
-        while(!table.empty()){
-            Node* currNode = table.front();
-            table.pop_front();
-            if(currNode->sibling != nullptr) table.push_back(currNode->sibling);
-            if(currNode->child != nullptr) table.push_back(currNode->child);
-            
-            this->addNode(currNode->elt);
-            delete currNode; currNode = nullptr;
+        // take the tree apart into one sibling list of single nodes, using
+        // the same rotation as the destructor
+        Node* nodeList = nullptr;
+        Node* currNode = this->root;
+        while(currNode != nullptr){
+            if(currNode->child != nullptr){
+                Node* child = currNode->child;
+                currNode->child = child->sibling;
+                child->sibling = currNode;
+                currNode = child;
+            }
+            else{
+                Node* next = currNode->sibling;
+                currNode->sibling = nodeList;
+                currNode->previous = nullptr;
+                nodeList = currNode;
+                currNode = next;
+            }
         }
+        this->root = this->mergePairs(nodeList);
     } // updatePriorities()
 
     // MODIFY: insert the new element and update the size
@@ -132,38 +137,47 @@ public:
         this->addNode(val);
     } // push()
 
-    // MODIFY: pop the root and meld all children, update pqsize also
-    // Runtime: Amortized O(log(n))
-    void pop() override {
-        if(this->pqSize == 1){
-            delete this->root;
-            this->root = nullptr;
-            this->pqSize--;
-        }
-        // if the pq have at least two nodes
-        else{
-            std::deque<Node*> table;
-            Node* currChild = this->root->child;
-            delete this->root; this->root = nullptr;
-            this->pqSize--;
-            while(currChild->sibling != nullptr){
-                currChild = currChild->sibling;
-                currChild->previous->sibling = nullptr;
-                currChild->previous->previous = nullptr;
-                table.push_back(currChild->previous);
+    // MODIFY: insert all elements of an iterator range and update the size. The
+    //         new nodes are first paired up among themselves by multipass pairing
+    //         and the resulting tree is melded with the root once
+    //         If copying an element throws, the new nodes are destroyed and
+    //         the heap is left as it was
+    // Runtime: O(k) where k is number of elements in range
+    template<typename InputIterator>
+    void push_range(InputIterator start, InputIterator end){
+        Node* batch = nullptr;
+        Node* batchEnd = nullptr;
+        std::size_t added = 0;
+        try{
+            for(; start != end; ++start){
+                Node* newNode = this->nodes.create(*start);
+                if(batchEnd == nullptr) batch = newNode;
+                else batchEnd->sibling = newNode;
+                batchEnd = newNode;
+                added++;
             }
-            currChild->previous = nullptr;
-            table.push_back(currChild); currChild = nullptr;
-            while(table.size() > 1){
-                Node* subRoot1 = table.front();
-                table.pop_front();
-                Node* subRoot2 = table.front();
-                table.pop_front();
-                table.push_back(this->meld(subRoot1, subRoot2));
+        }
+        catch(...){
+            while(batch != nullptr){
+                Node* next = batch->sibling;
+                this->nodes.destroy(batch);
+                batch = next;
             }
-            this->root = table.front();
-            table.pop_front();
+            throw;
         }
+        this->pqSize += added;
+        if(batch == nullptr) return;
+        batch = this->multipassPairs(batch);
+        this->root = (this->root == nullptr) ? batch : this->meld(this->root, batch);
+    } // push_range()
+
+    // MODIFY: pop the root and meld all children, update pqsize also
+    // Runtime: Amortized O(log(n))
+    void pop() override {
+        Node* children = this->root->child;
+        this->nodes.destroy(this->root);
+        this->root = this->mergePairs(children);
+        this->pqSize--;
     } // pop()
 
     const TYPE& top() const override {
@@ -181,50 +195,74 @@ public:
         else return false;
     } // empty()
 
-    // REQUIRE: new value is larger than old value, node must points to any node in this pq
+    // REQUIRE: node must points to any node in this pq
     // MODIFY: make this priority queue valid again
     // EFFECT: replace the old value referenced by node with new_value, then extract this node
-    //         and meld this node with the root
+    //         and meld this node with the root. If the new value is smaller than the old one,
+    //         the children of the node are paired up and melded back separately, since they
+    //         may now be larger than the node
+    // Runtime: Amortized O(log(n))
     void updateElt(Node* node, const TYPE & new_value) {
-        if(node == this->root) return;
-        else{
-            node->elt = new_value;
-            // if we deal with the leftmost node
-            if(node->previous->child == node){
-                node->previous->child = node->sibling;
-                // if the sibling of this node is not nullptr
-                if(node->sibling != nullptr){
-                    node->sibling->previous = node->previous;
-                }
-                node->previous = nullptr;
-                node->sibling = nullptr;
-                this->root = this->meld(node, this->root); node = nullptr;
-            }
-            // if we deal with the sibling node
-            else{
-                node->previous->sibling = node->sibling;
-                // if the sibling of this node is not nullptr
-                if(node->sibling != nullptr){
-                    node->sibling->previous = node->previous;
-                }
-                node->previous = nullptr;
-                node->sibling = nullptr;
-                this->root = this->meld(node, this->root); node = nullptr;
+        bool decreased = this->compare(new_value, node->elt);
+        node->elt = new_value;
+        if(node == this->root && !decreased) return;
+
+        Node* rest = nullptr;
+        if(node != this->root){
+            rest = this->root;
+            this->detach(node);
+        }
+        if(decreased){
+            Node* children = this->mergePairs(node->child);
+            node->child = nullptr;
+            if(children != nullptr){
+                rest = (rest == nullptr) ? children : this->meld(rest, children);
             }
         }
+        this->root = (rest == nullptr) ? node : this->meld(rest, node);
     } // updateElt()
 
 
+    // REQUIRE: node must points to any node in this pq
+    // MODIFY: remove the element referenced by node and update pqSize, node is deleted
+    // Runtime: Amortized O(log(n))
+    void erase(Node* node) {
+        if(node == this->root){
+            this->pop();
+            return;
+        }
+        this->detach(node);
+        Node* children = this->mergePairs(node->child);
+        this->nodes.destroy(node);
+        this->pqSize--;
+        if(children != nullptr) this->root = this->meld(this->root, children);
+    } // erase()
+
+
+    // REQUIRE: other uses the same ordering as this pq
+    // MODIFY: move all elements of other into this pq and leave other empty, pointers
+    //         returned by other.addNode() now refer to nodes in this pq
+    // Runtime: O(1)
+    void merge(PairingPQ&& other) {
+        if(&other == this || other.root == nullptr) return;
+        this->nodes.absorb(other.nodes);
+        this->root = (this->root == nullptr) ? other.root : this->meld(this->root, other.root);
+        this->pqSize += other.pqSize;
+        other.root = nullptr;
+        other.pqSize = 0;
+    } // merge()
+
+
     // MODIFY: update the root and pqSize
     // EFFECT: return the pointer that points to new added node
     Node* addNode(const TYPE& val) {
         if(this->pqSize == 0){
-            this->root = new Node(val);
+            this->root = this->nodes.create(val);
             this->pqSize++;
             return this->root;
         }
         else{
-            Node* temp = new Node(val);
+            Node* temp = this->nodes.create(val);
             this->root = this->meld(temp, this->root); 
             this->pqSize++;
             return temp;
@@ -234,9 +272,64 @@ public:
 private:
     Node* root;
     std::size_t pqSize;
+    NodeStore<Node> nodes;
     // COMP_FUNCTOR compare
 
 
+    // REQUIRE: copyNode is the copy of currNode, currNode is the root of other
+    // MODIFY: copy the rest of other's tree below copyNode
+    void copyNodes(const Node* currNode, Node* copyNode){
+        while(true){
+            if(currNode->child != nullptr){
+                currNode = currNode->child;
+                Node* newNode = this->nodes.create(currNode->elt);
+                copyNode->child = newNode;
+                newNode->previous = copyNode;
+                copyNode = newNode;
+                continue;
+            }
+            // climb until we find a node that still has a right sibling
+            while(currNode != nullptr && currNode->sibling == nullptr){
+                // walk left to the leftmost sibling, its previous is the parent
+                while(currNode->previous != nullptr && currNode->previous->child != currNode){
+                    currNode = currNode->previous;
+                    copyNode = copyNode->previous;
+                }
+                currNode = currNode->previous;
+                copyNode = copyNode->previous;
+            }
+            if(currNode == nullptr) break;
+            currNode = currNode->sibling;
+            Node* newNode = this->nodes.create(currNode->elt);
+            copyNode->sibling = newNode;
+            newNode->previous = copyNode;
+            copyNode = newNode;
+        }
+    }
+
+    // MODIFY: destroy every node of the tree from root, without recursion
+    void destroyNodes(){
+        Node* currNode = this->root;
+        while(currNode != nullptr){
+            // rotate the leftmost child up until the node has no child left,
+            // then it can be destroyed and we continue with its sibling.
+            // The memory itself is released by the node store
+            if(currNode->child != nullptr){
+                Node* child = currNode->child;
+                currNode->child = child->sibling;
+                child->sibling = currNode;
+                currNode = child;
+            }
+            else{
+                Node* next = currNode->sibling;
+                currNode->~Node();
+                currNode = next;
+            }
+        }
+        this->root = nullptr;
+    }
+
+
     // REQUIRE: parameters's sibling and previos must be nullptr, root can't be nullptr
     //          also, must point the original two roots to nullptr after call this function
     // EFFECT: meld two pairing heap, the smaller root will be the leftmost child of the larger one
@@ -265,6 +358,86 @@ private:
         }
     }
 
+    // REQUIRE: node is in this pq and is not the root
+    // MODIFY: unlink node, together with its children, from its parent and siblings
+    void detach(Node* node){
+        // if we deal with the leftmost node
+        if(node->previous->child == node) node->previous->child = node->sibling;
+        // if we deal with the sibling node
+        else node->previous->sibling = node->sibling;
+        if(node->sibling != nullptr) node->sibling->previous = node->previous;
+        node->previous = nullptr;
+        node->sibling = nullptr;
+    }
+
+    // REQUIRE: first is the leftmost node of a non-empty sibling list, previous
+    //          pointers of the list must be nullptr
+    // EFFECT: meld all trees of the list by multipass pairing, each pass melds
+    //         neighbours and keeps the results in order, until one tree is left.
+    //         Return its root
+    Node* multipassPairs(Node* first){
+        while(first->sibling != nullptr){
+            Node* passBegin = nullptr;
+            Node* passEnd = nullptr;
+            while(first != nullptr){
+                Node* melded = first;
+                Node* subRoot2 = first->sibling;
+                first = (subRoot2 == nullptr) ? nullptr : subRoot2->sibling;
+                melded->sibling = nullptr;
+                if(subRoot2 != nullptr){
+                    subRoot2->sibling = nullptr;
+                    melded = this->meld(melded, subRoot2);
+                }
+                if(passEnd == nullptr) passBegin = melded;
+                else passEnd->sibling = melded;
+                passEnd = melded;
+            }
+            first = passBegin;
+        }
+        return first;
+    }
+
+    // REQUIRE: first is the leftmost node of a sibling list (or nullptr), the
+    //          previous pointers of the list are ignored
+    // EFFECT: meld all trees of the list with the standard two-pass pairing and
+    //         return the new root, nullptr if the list is empty. The first pass
+    //         melds pairs from left to right and chains the results backwards
+    //         through their sibling pointers, the second pass melds that chain
+    //         from right to left, so no extra container is needed
+    Node* mergePairs(Node* first){
+        if(first == nullptr) return nullptr;
+        Node* paired = nullptr;
+        while(first != nullptr){
+            Node* subRoot1 = first;
+            Node* subRoot2 = first->sibling;
+            subRoot1->sibling = nullptr;
+            subRoot1->previous = nullptr;
+            if(subRoot2 == nullptr){
+                first = nullptr;
+                subRoot1->sibling = paired;
+                paired = subRoot1;
+            }
+            else{
+                first = subRoot2->sibling;
+                subRoot2->sibling = nullptr;
+                subRoot2->previous = nullptr;
+                Node* melded = this->meld(subRoot1, subRoot2);
+                melded->sibling = paired;
+                paired = melded;
+            }
+        }
+        Node* result = paired;
+        paired = paired->sibling;
+        result->sibling = nullptr;
+        while(paired != nullptr){
+            Node* next = paired->sibling;
+            paired->sibling = nullptr;
+            result = this->meld(paired, result);
+            paired = next;
+        }
+        return result;
+    }
+
 };
 
 
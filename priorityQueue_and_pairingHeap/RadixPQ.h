@@ -0,0 +1,209 @@
+// Project identifier: 0E04A31E0D60C01986ACB20081C9D8722A1899B6
+
+#ifndef RADIXPQ_H
+#define RADIXPQ_H
+
+#include "Eecs281PQ.h"
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+// Default key of RadixPQ: the element is its own key.
+template<typename TYPE>
+struct RadixIdentityKey {
+    TYPE operator()(const TYPE& val) const {
+        return val;
+    }
+};
+
+// The comparison functor of RadixPQ: an element with a larger key has lower
+// priority, so the smallest key is the most extreme element.
+template<typename TYPE, typename KEY_FUNCTOR>
+struct RadixKeyGreater {
+    KEY_FUNCTOR key;
+
+    bool operator()(const TYPE& a, const TYPE& b) const {
+        return key(a) > key(b);
+    }
+};
+
+
+// A specialized version of the 'priority_queue' ADT implemented as a radix
+// heap, for elements with an unsigned integer key (given by KEY_FUNCTOR) that
+// never drops below the key of the last extracted element, as in Dijkstra's
+// algorithm or a timer queue. The smallest key is on top.
+//
+// Every element sits in the bucket numbered by the highest bit in which its
+// key differs from 'last', the key of the last element returned by top() or
+// removed by pop(), bucket 0 holds the keys equal to it. Buckets are plain
+// vectors, so pushing is an append and no element is ever compared with
+// another one during a push. When top() or pop() find bucket 0 empty, the
+// first non-empty bucket is split up again around its smallest key. Each
+// element can only move to lower buckets, so it is moved at most once per bit
+// of the key.
+template<typename TYPE, typename KEY_FUNCTOR = RadixIdentityKey<TYPE>>
+class RadixPQ final : public Eecs281PQ<TYPE, RadixKeyGreater<TYPE, KEY_FUNCTOR>> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281PQ<TYPE, RadixKeyGreater<TYPE, KEY_FUNCTOR>>;
+
+    using KeyType = typename std::decay<decltype(std::declval<const KEY_FUNCTOR&>()(std::declval<const TYPE&>()))>::type;
+    static_assert(std::is_integral<KeyType>::value && std::is_unsigned<KeyType>::value,
+                  "RadixPQ needs an unsigned integer key");
+
+    static const std::size_t KEY_BITS = std::numeric_limits<KeyType>::digits;
+
+public:
+    // Description: Construct an empty heap with an optional key functor.
+    // Runtime: O(number of bits of the key)
+    explicit RadixPQ(KEY_FUNCTOR key = KEY_FUNCTOR()) :
+        BaseClass{ RadixKeyGreater<TYPE, KEY_FUNCTOR>{ key } }, buckets(KEY_BITS + 1),
+        last{ 0 }, pqSize{ 0 } {
+    } // RadixPQ()
+
+
+    // Description: Construct a heap out of an iterator range with an optional
+    //              key functor.
+    // Runtime: O(n) where n is number of elements in range.
+    template<typename InputIterator>
+    RadixPQ(InputIterator start, InputIterator end, KEY_FUNCTOR key = KEY_FUNCTOR()) :
+        RadixPQ{ key } {
+        this->buckets[KEY_BITS].assign(start, end);
+        this->pqSize = this->buckets[KEY_BITS].size();
+        this->updatePriorities();
+    } // RadixPQ()
+
+
+    // Description: Destructor doesn't need any code, the buckets will
+    //              be destroyed automaticslly.
+    ~RadixPQ() override {
+    } // ~RadixPQ()
+
+
+    // Description: Assumes that the keys of all elements may have changed and
+    //              sorts them into buckets again. The keys must still be no
+    //              smaller than the key of the last element returned by top()
+    //              or removed by pop().
+    // Runtime: O(n)
+    void updatePriorities() override {
+        std::vector<TYPE> all;
+        all.reserve(this->pqSize);
+        for(std::vector<TYPE>& bucket : this->buckets){
+            for(TYPE& val : bucket) all.push_back(std::move(val));
+            bucket.clear();
+        }
+        for(TYPE& val : all) this->insert(std::move(val));
+    } // updatePriorities()
+
+
+    // Description: Add a new element to the heap.
+    // REQUIRE: the key of val is no smaller than the key of the last element
+    //          returned by top() or removed by pop()
+    // Runtime: O(1)
+    void push(const TYPE& val) override {
+        this->insert(val);
+        this->pqSize++;
+    } // push()
+
+
+    // Description: Remove the element with the smallest key from the heap.
+    // Runtime: Amortized O(number of bits of the key)
+    void pop() override {
+        if(this->buckets[0].empty()) this->refill();
+        this->buckets[0].pop_back();
+        this->pqSize--;
+    } // pop()
+
+
+    // Description: Return the element with the smallest key.
+    // Runtime: Amortized O(number of bits of the key)
+    // Note: If top() was called since the last pop(), this function is O(1).
+    const TYPE& top() const override {
+        if(this->buckets[0].empty()) this->refill();
+        return this->buckets[0].back();
+    } // top()
+
+
+    // Description: Get the number of elements in the heap.
+    // Runtime: O(1)
+    std::size_t size() const override {
+        return this->pqSize;
+    } // size()
+
+
+    // Description: Return true if the heap is empty.
+    // Runtime: O(1)
+    bool empty() const override {
+        return this->pqSize == 0;
+    } // empty()
+
+
+private:
+    // buckets[0] holds the elements with key == last, buckets[i] the ones whose
+    // key differs from last first in bit i - 1. top() may move elements
+    // between buckets, so they are mutable.
+    mutable std::vector<std::vector<TYPE>> buckets;
+    mutable KeyType last;
+    std::size_t pqSize;
+    // RadixKeyGreater compare; (base class), compare.key extracts the keys
+
+    // EFFECT: return the bucket for key
+    std::size_t bucketOf(KeyType key) const {
+        KeyType diff = key ^ this->last;
+        if(diff == 0) return 0;
+        return KEY_BITS - countLeadingZeros(diff);
+    }
+
+    // REQUIRE: x != 0
+    // EFFECT: return the number of leading zero bits of x
+    static std::size_t countLeadingZeros(KeyType x) {
+#if defined(__GNUC__)
+        return __builtin_clzll(static_cast<unsigned long long>(x))
+            - (std::numeric_limits<unsigned long long>::digits - KEY_BITS);
+#else
+        std::size_t zeros = 0;
+        for(KeyType mask = KeyType(1) << (KEY_BITS - 1); (x & mask) == 0; mask >>= 1) ++zeros;
+        return zeros;
+#endif
+    }
+
+    // REQUIRE: key of val >= last
+    // MODIFY: put val into its bucket
+    template<typename T>
+    void insert(T&& val) const {
+        KeyType key = this->compare.key(val);
+        assert(key >= this->last && "RadixPQ keys must not drop below the last extracted key");
+        this->buckets[this->bucketOf(key)].push_back(std::forward<T>(val));
+    }
+
+    // REQUIRE: elements is not empty
+    // EFFECT: return the smallest key in elements
+    KeyType minKey(const std::vector<TYPE>& elements) const {
+        KeyType smallest = this->compare.key(elements[0]);
+        for(const TYPE& val : elements){
+            KeyType key = this->compare.key(val);
+            if(key < smallest) smallest = key;
+        }
+        return smallest;
+    }
+
+    // REQUIRE: buckets[0] is empty and the heap is not
+    // MODIFY: make the smallest key the new last and spread the first
+    //         non-empty bucket over the lower buckets
+    void refill() const {
+        std::size_t index = 1;
+        while(this->buckets[index].empty()) ++index;
+        std::vector<TYPE> moving;
+        moving.swap(this->buckets[index]);
+        this->last = this->minKey(moving);
+        for(TYPE& val : moving) this->insert(std::move(val));
+        // keep the memory of the bucket for later pushes
+        moving.clear();
+        this->buckets[index].swap(moving);
+    }
+}; // RadixPQ
+
+#endif // RADIXPQ_H
@@ -0,0 +1,405 @@
+// Project identifier: 0E04A31E0D60C01986ACB20081C9D8722A1899B6
+
+#ifndef RANKPAIRINGPQ_H
+#define RANKPAIRINGPQ_H
+
+#include "Eecs281PQ.h"
+#include "NodeStore.h"
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+// A specialized version of the 'priority_queue' ADT implemented as a (type-2)
+// rank-pairing heap. Nodes are handed out by addNode() like in PairingPQ, and
+// making an element more extreme with updateElt() is amortized O(1).
+//
+// The heap is a circular list of half-trees: binary trees whose root has only
+// a left child, and in which every node is at least as extreme as all nodes
+// in its left subtree. The list is linked through the right pointers of the
+// roots, and 'root' is the most extreme one. Every node has a rank, a root has
+// the rank of its left child plus one. Roots are only linked in pop(), in one
+// pass that links each pair of roots of the same rank it finds.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+class RankPairingPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+    // Each node within the rank-pairing heap
+    class Node {
+        public:
+            explicit Node(const TYPE &val)
+                : elt{ val }, parent{ nullptr }, left{ nullptr }, right{ this }, rank{ 0 }
+            {}
+
+            // Description: Allows access to the element at that Node's position.
+            // Runtime: O(1)
+            const TYPE &getElt() const { return elt; }
+
+            friend RankPairingPQ;
+
+        private:
+            TYPE elt;
+            // nullptr for a root
+            Node* parent;
+            Node* left;
+            // right child, or the next root in the root list for a root
+            Node* right;
+            int rank;
+    }; // Node
+
+    // Description: Construct an empty priority_queue with an optional comparison functor.
+    // Runtime: O(1)
+    explicit RankPairingPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp }, root{ nullptr }, pqSize{ 0 } {}
+
+
+    // Description: Construct a priority_queue out of an iterator range with an optional
+    //              comparison functor.
+    // Runtime: O(n) where n is number of elements in range.
+    template<typename InputIterator>
+    RankPairingPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        BaseClass{ comp }, root{ nullptr }, pqSize{ 0 } {
+        while(start != end){
+            this->addNode(*start);
+            ++start;
+        }
+    } // RankPairingPQ()
+
+
+    // Description: Copy constructor. The copy holds the same elements as
+    //              single node half-trees in one block of memory, the first
+    //              pop() links them.
+    // Runtime: O(n)
+    RankPairingPQ(const RankPairingPQ& other) : BaseClass{ other.compare }, root{ nullptr }, pqSize{ 0 } {
+        if(other.root == nullptr) return;
+        this->nodes.reserve(other.pqSize);
+        // if copying an element throws, the nodes added so far are a valid
+        // heap and are destroyed like in the destructor
+        try{
+            const Node* currRoot = other.root;
+            do{
+                this->addNode(currRoot->elt);
+                // preorder walk of the left subtree, climbing back up through the
+                // parent pointers until a right child is left to visit
+                const Node* subtree = currRoot->left;
+                const Node* currNode = subtree;
+                while(currNode != nullptr){
+                    this->addNode(currNode->elt);
+                    if(currNode->left != nullptr) currNode = currNode->left;
+                    else if(currNode->right != nullptr) currNode = currNode->right;
+                    else{
+                        while(currNode != subtree &&
+                              (currNode->parent->right == currNode || currNode->parent->right == nullptr)){
+                            currNode = currNode->parent;
+                        }
+                        currNode = (currNode == subtree) ? nullptr : currNode->parent->right;
+                    }
+                }
+                currRoot = currRoot->right;
+            } while(currRoot != other.root);
+        }
+        catch(...){
+            this->destroyNodes();
+            throw;
+        }
+    } // RankPairingPQ()
+
+    // Description: Copy assignment operator.
+    // Runtime: O(n)
+    RankPairingPQ& operator=(const RankPairingPQ& rhs) {
+        RankPairingPQ temp(rhs);
+        std::swap(this->root, temp.root);
+        std::swap(this->pqSize, temp.pqSize);
+        std::swap(this->compare, temp.compare);
+        this->nodes.swap(temp.nodes);
+        return *this;
+    } // operator=()
+
+    // Description: Destructor
+    // Runtime: O(n)
+    ~RankPairingPQ() override {
+        this->destroyNodes();
+    } // ~RankPairingPQ()
+
+    // Description: Assumes that all elements inside the priority_queue are out of order and
+    //              'rebuilds' the priority_queue by fixing the priority_queue invariant.
+    //              The nodes are reused, so pointers from addNode() stay valid.
+    // Runtime: O(n)
+    void updatePriorities() override {
+        if(this->root == nullptr) return;
+        Node* currNode = this->flatten();
+        this->root = nullptr;
+        this->pqSize = 0;
+        while(currNode != nullptr){
+            Node* next = currNode->right;
+            this->insertRoot(currNode);
+            currNode = next;
+        }
+    } // updatePriorities()
+
+    // MODIFY: insert the new element and update the size
+    // Runtime: O(1)
+    void push(const TYPE& val) override {
+        this->addNode(val);
+    } // push()
+
+    // MODIFY: remove the most extreme element, split its left subtree into
+    //         half-trees and link the roots in one pass
+    // Runtime: Amortized O(log(n))
+    void pop() override {
+        this->nodes.destroy(this->removeRoot());
+    } // pop()
+
+    // Runtime: O(1)
+    const TYPE& top() const override {
+        return this->root->elt;
+    } // top()
+
+    // Runtime: O(1)
+    std::size_t size() const override {
+        return this->pqSize;
+    } // size()
+
+    // Runtime: O(1)
+    bool empty() const override {
+        return this->pqSize == 0;
+    } // empty()
+
+    // REQUIRE: node must points to any node in this pq
+    // MODIFY: make this priority queue valid again
+    // EFFECT: replace the old value referenced by node with new_value. If the new value
+    //         is not smaller than the old one, the node and its left subtree become a new
+    //         half-tree and the ranks above it are lowered where they are too high.
+    //         Otherwise the node is taken out like in pop() and put back as a single
+    //         node half-tree, since its left subtree may now be larger
+    // Runtime: Amortized O(1) if the value does not get smaller, else amortized O(log(n))
+    void updateElt(Node* node, const TYPE & new_value) {
+        bool decreased = this->compare(new_value, node->elt);
+        if(decreased){
+            this->extract(node);
+            node->elt = new_value;
+            this->insertRoot(node);
+            return;
+        }
+        node->elt = new_value;
+        if(node->parent != nullptr) this->cut(node);
+        if(this->compare(this->root->elt, node->elt)) this->root = node;
+    } // updateElt()
+
+
+    // REQUIRE: node must points to any node in this pq
+    // MODIFY: remove the element referenced by node and update pqSize, node is deleted
+    // Runtime: Amortized O(log(n))
+    void erase(Node* node) {
+        this->extract(node);
+        this->nodes.destroy(node);
+    } // erase()
+
+
+    // REQUIRE: other uses the same ordering as this pq
+    // MODIFY: move all elements of other into this pq and leave other empty, pointers
+    //         returned by other.addNode() now refer to nodes in this pq
+    // Runtime: O(1)
+    void merge(RankPairingPQ&& other) {
+        if(&other == this || other.root == nullptr) return;
+        this->nodes.absorb(other.nodes);
+        if(this->root == nullptr) this->root = other.root;
+        else{
+            std::swap(this->root->right, other.root->right);
+            if(this->compare(this->root->elt, other.root->elt)) this->root = other.root;
+        }
+        this->pqSize += other.pqSize;
+        other.root = nullptr;
+        other.pqSize = 0;
+    } // merge()
+
+
+    // MODIFY: update the root and pqSize
+    // EFFECT: return the pointer that points to new added node
+    // Runtime: O(1)
+    Node* addNode(const TYPE& val) {
+        Node* newNode = this->nodes.create(val);
+        this->insertRoot(newNode);
+        return newNode;
+    } // addNode()
+
+private:
+    // the most extreme root, any node of the root list
+    Node* root;
+    std::size_t pqSize;
+    NodeStore<Node> nodes;
+    // roots by rank while pop() links them, kept to reuse its memory
+    std::vector<Node*> byRank;
+    // COMP_FUNCTOR compare
+
+    // MODIFY: destroy every node, the memory is released by the node store
+    void destroyNodes(){
+        if(this->root == nullptr) return;
+        Node* currNode = this->flatten();
+        while(currNode != nullptr){
+            Node* next = currNode->right;
+            currNode->~Node();
+            currNode = next;
+        }
+        this->root = nullptr;
+    }
+
+
+    static int rankOf(const Node* node){
+        return (node == nullptr) ? -1 : node->rank;
+    }
+
+    // REQUIRE: node is a root that is not in the root list yet
+    // MODIFY: add node to the root list, right after root, and update root
+    void addRoot(Node* node){
+        if(this->root == nullptr){
+            node->right = node;
+            this->root = node;
+            return;
+        }
+        node->right = this->root->right;
+        this->root->right = node;
+        if(this->compare(this->root->elt, node->elt)) this->root = node;
+    }
+
+    // REQUIRE: node is not in the heap
+    // MODIFY: add node as a single node half-tree, update root and pqSize
+    void insertRoot(Node* node){
+        node->parent = node->left = nullptr;
+        node->rank = 0;
+        this->addRoot(node);
+        this->pqSize++;
+    }
+
+    // REQUIRE: node has a parent
+    // MODIFY: move node and its left subtree into a new half-tree. Its right
+    //         child takes its place, then the ranks of the ancestors are
+    //         lowered until one already satisfies the rank rule
+    void cut(Node* node){
+        Node* parent = node->parent;
+        Node* right = node->right;
+        if(parent->left == node) parent->left = right;
+        else parent->right = right;
+        if(right != nullptr) right->parent = parent;
+        node->parent = nullptr;
+        node->rank = rankOf(node->left) + 1;
+        this->addRoot(node);
+
+        while(parent != nullptr){
+            int newRank;
+            if(parent->parent == nullptr) newRank = rankOf(parent->left) + 1;
+            else{
+                int r1 = rankOf(parent->left);
+                int r2 = rankOf(parent->right);
+                if(r1 < r2) std::swap(r1, r2);
+                newRank = (r1 > r2 + 1) ? r1 : r1 + 1;
+            }
+            if(newRank >= parent->rank) break;
+            parent->rank = newRank;
+            parent = parent->parent;
+        }
+    }
+
+    // REQUIRE: node is in this pq
+    // MODIFY: take node out of the heap and update pqSize, node is not destroyed
+    void extract(Node* node){
+        if(node->parent != nullptr) this->cut(node);
+        // removeRoot() does not look at the root's value before it is gone
+        this->root = node;
+        this->removeRoot();
+    }
+
+    // REQUIRE: both are roots of the same rank and not in the root list
+    // EFFECT: make the less extreme one the left child of the other and
+    //         return the new root
+    Node* link(Node* root1, Node* root2){
+        if(this->compare(root1->elt, root2->elt)) std::swap(root1, root2);
+        root2->right = root1->left;
+        if(root2->right != nullptr) root2->right->parent = root2;
+        root2->parent = root1;
+        root1->left = root2;
+        root1->rank++;
+        return root1;
+    }
+
+    // REQUIRE: node is a root that is not in the root list
+    // MODIFY: link node with a waiting root of the same rank and add the
+    //         result to the root list, or let node wait for one
+    void linkOrWait(Node* node){
+        std::size_t rank = static_cast<std::size_t>(node->rank);
+        if(rank >= this->byRank.size()) this->byRank.resize(rank + 1, nullptr);
+        if(this->byRank[rank] == nullptr){
+            this->byRank[rank] = node;
+            return;
+        }
+        Node* other = this->byRank[rank];
+        this->byRank[rank] = nullptr;
+        this->addRoot(this->link(node, other));
+    }
+
+    // REQUIRE: the heap is not empty
+    // MODIFY: take the root out of the heap, split its left subtree along the
+    //         right spine into half-trees and link the roots in one pass
+    // EFFECT: return the removed node
+    Node* removeRoot(){
+        Node* removed = this->root;
+        Node* spine = removed->left;
+        Node* currRoot = removed->right;
+        this->root = nullptr;
+        this->pqSize--;
+
+        while(currRoot != removed){
+            Node* next = currRoot->right;
+            this->linkOrWait(currRoot);
+            currRoot = next;
+        }
+        while(spine != nullptr){
+            Node* next = spine->right;
+            spine->parent = nullptr;
+            spine->right = nullptr;
+            spine->rank = rankOf(spine->left) + 1;
+            this->linkOrWait(spine);
+            spine = next;
+        }
+        for(Node*& slot : this->byRank){
+            if(slot == nullptr) continue;
+            this->addRoot(slot);
+            slot = nullptr;
+        }
+        removed->left = nullptr;
+        removed->right = removed;
+        return removed;
+    }
+
+    // REQUIRE: the heap is not empty
+    // EFFECT: take all nodes apart and return them as a list linked through
+    //         their right pointers, ending with nullptr
+    Node* flatten(){
+        // turn the root list into one binary tree through the right pointers,
+        // then rotate left children up until none is left
+        Node* first = this->root->right;
+        this->root->right = nullptr;
+        Node* list = nullptr;
+        Node* currNode = first;
+        while(currNode != nullptr){
+            if(currNode->left != nullptr){
+                Node* leftChild = currNode->left;
+                currNode->left = leftChild->right;
+                leftChild->right = currNode;
+                currNode = leftChild;
+            }
+            else{
+                Node* next = currNode->right;
+                currNode->right = list;
+                list = currNode;
+                currNode = next;
+            }
+        }
+        return list;
+    }
+}; // RankPairingPQ
+
+
+#endif // RANKPAIRINGPQ_H
@@ -6,14 +6,22 @@
 #include "Eecs281PQ.h"
 #include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <limits>
 
-// A specialized version of the 'heap' ADT that is implemented with an
-// underlying sorted array-based container.
-// Note: The most extreme element should be found at the end of the
-// 'data' container, such that traversing the iterators yields the elements in
-// sorted order.
+// A specialized version of the 'heap' ADT that is implemented with underlying
+// sorted array-based containers, in the style of a log-structured merge tree.
+// New elements are inserted by binary search into a small sorted buffer. A full
+// buffer becomes a sorted run, and runs of similar size are merged, so run
+// sizes at least double from the newest run to the oldest one and there are
+// only O(log n) of them. A run that pop() shrinks below twice the size of the
+// next newer run is merged with it again, so the bound holds after pops too.
+// The most extreme element is at the end of one of the runs or of the buffer.
+// Note: sorted() merges everything into one container, such that traversing
+// its iterators yields the elements in sorted order, with the most extreme
+// element at the end.
 template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
-class SortedPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+class SortedPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
     // This is a way to refer to the base class object.
     using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
 
@@ -21,73 +29,106 @@ public:
     // Description: Construct an empty heap with an optional comparison functor.
     // Runtime: O(1)
     explicit SortedPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) :
-        BaseClass{ comp } {
+        BaseClass{ comp }, pqSize{ 0 }, extreme{ UNKNOWN_RUN } {
     } // SortedPQ
 
 
     // Description: Construct a heap out of an iterator range with an optional
     //              comparison functor.
     // Runtime: O(n log n) where n is number of elements in range.
-    // TODO: When you implement this function, uncomment the parameter names.
     template<typename InputIterator>
     SortedPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
-        BaseClass{ comp }, data(start, end) {
-        std::sort(this->data.begin(), this->data.end(), this->compare);
+        BaseClass{ comp }, pqSize{ 0 }, extreme{ UNKNOWN_RUN } {
+        this->push_range(start, end);
     } // SortedPQ
 
 
-    // Description: Destructor doesn't need any code, the data vector will
+    // Description: Destructor doesn't need any code, the runs will
     //              be destroyed automaticslly.
     ~SortedPQ() override{
     } // ~SortedPQ()
 
 
     // Description: Add a new element to the heap.
-    // Runtime: O(n)
-    // TODO: When you implement this function, uncomment the parameter names.
+    // Runtime: Amortized O(log(n)) compares and moves, plus O(BUFFER_SIZE)
+    //          moves inside the buffer
     void push(const TYPE& val) override{
-        auto it = this->data.begin();
-        for(; it != this->data.end(); ++it){
-            if(this->compare(val, *it)) break;
+        auto it = std::upper_bound(this->buffer.begin(), this->buffer.end(), val, this->compare);
+        this->buffer.insert(it, val);
+        this->pqSize++;
+        this->extreme = UNKNOWN_RUN;
+        if(this->buffer.size() >= BUFFER_SIZE){
+            std::vector<TYPE> run;
+            run.swap(this->buffer);
+            this->addRun(std::move(run));
         }
-
-        this->data.insert(it, val);
     } // push()
 
 
+    // Description: Add all elements of an iterator range to the heap. The new
+    //              elements are sorted on their own and added as one run.
+    // Runtime: O(k log(k)) plus amortized merging, where k is number of
+    //          elements in range.
+    template<typename InputIterator>
+    void push_range(InputIterator start, InputIterator end){
+        std::vector<TYPE> run(start, end);
+        if(run.empty()) return;
+        std::sort(run.begin(), run.end(), this->compare);
+        this->pqSize += run.size();
+        this->extreme = UNKNOWN_RUN;
+        this->addRun(std::move(run));
+    } // push_range()
+
+
     // Description: Remove the most extreme (defined by 'compare') element from
     //              the heap.
     // Note: We will not run tests on your code that would require it to pop an
     // element when the heap is empty. Though you are welcome to if you are
     // familiar with them, you do not need to use exceptions in this project.
-    // Runtime: Amortized O(1)
+    // Runtime: O(log(n)), plus merging the run the element came from with its
+    //          neighbours when it got too small for its place
+    // Note: If top() was called before pop(), this function is amortized O(1)
+    //       apart from those merges.
     void pop() override{
-        this->data.pop_back();
+        if(this->extreme == UNKNOWN_RUN) this->findExtreme();
+        if(this->extreme == this->runs.size()){
+            this->buffer.pop_back();
+        }
+        else{
+            this->runs[this->extreme].pop_back();
+            if(this->runs[this->extreme].empty()){
+                this->runs.erase(this->runs.begin() + this->extreme);
+            }
+            else this->restoreRuns(this->extreme);
+        }
+        this->pqSize--;
+        this->extreme = UNKNOWN_RUN;
     } // pop()
 
     // Description: Return the most extreme (defined by 'compare') element of
     //              the vector.  This should be a reference for speed.  It MUST
     //              be const because we cannot allow it to be modified, as that
     //              might make it no longer be the most extreme element.
-    // Runtime: O(1)
+    // Runtime: O(log(n))
+    // Note: If the most extreme element is already known, this function is O(1).
     const TYPE& top() const override{
-        return this->data.back();
+        if(this->extreme == UNKNOWN_RUN) this->findExtreme();
+        if(this->extreme == this->runs.size()) return this->buffer.back();
+        return this->runs[this->extreme].back();
     } // top()
 
 
     // Description: Get the number of elements in the heap.
-    //              This has been implemented for you.
     // Runtime: O(1)
     std::size_t size() const override{
-        return data.size();
+        return this->pqSize;
     } // size()
 
 
     // Description: Return true if the heap is empty.
-    //              This has been implemented for you.
     // Runtime: O(1)
     virtual bool empty() const {
-        return data.empty();
+        return this->pqSize == 0;
     } // empty()
 
 
@@ -95,13 +136,122 @@ public:
     //              'rebuilds' the heap by fixing the heap invariant.
     // Runtime: O(n log n)
     virtual void updatePriorities() {
-        std::sort(this->data.begin(), this->data.end(), this->compare);
+        std::vector<TYPE> all;
+        all.reserve(this->pqSize);
+        this->moveAll(all);
+        std::sort(all.begin(), all.end(), this->compare);
+        if(!all.empty()) this->runs.push_back(std::move(all));
+        this->extreme = UNKNOWN_RUN;
     } // updatePriorities()
 
 
+    // Description: Merge all runs and the buffer into one container and
+    //              return it. Traversing it yields the elements in sorted order,
+    //              with the most extreme element at the end.
+    // Runtime: O(n log(n)) in the worst case, O(1) if nothing was pushed
+    //          since the last call
+    const std::vector<TYPE>& sorted() const {
+        static const std::vector<TYPE> none;
+        if(this->runs.empty() && this->buffer.empty()) return none;
+        if(this->runs.size() + (this->buffer.empty() ? 0 : 1) > 1 || this->runs.empty()){
+            if(!this->buffer.empty()){
+                std::vector<TYPE> run;
+                run.swap(this->buffer);
+                this->runs.push_back(std::move(run));
+            }
+            while(this->runs.size() > 1) this->mergeRuns(this->runs.size() - 2);
+            this->extreme = UNKNOWN_RUN;
+        }
+        return this->runs.front();
+    } // sorted()
+
+
+    // Description: Get the number of sorted runs, not counting the buffer.
+    // Runtime: O(1)
+    std::size_t runCount() const {
+        return this->runs.size();
+    } // runCount()
+
+
 private:
-    // Note: This vector *must* be used your heap implementation.
-    std::vector<TYPE> data;
+    // Buffer that new elements are inserted into before they become a run.
+    static const std::size_t BUFFER_SIZE = 64;
+    // Marks that the location of the most extreme element is not known.
+    static const std::size_t UNKNOWN_RUN = std::numeric_limits<std::size_t>::max();
+
+    // Sorted runs from the oldest, largest one to the newest. sorted() merges
+    // them from a const function, so they are mutable.
+    mutable std::vector<std::vector<TYPE>> runs;
+    // Sorted insertion buffer.
+    mutable std::vector<TYPE> buffer;
+    std::size_t pqSize;
+    // Index of the run with the most extreme element, runs.size() for the
+    // buffer, or UNKNOWN_RUN.
+    mutable std::size_t extreme;
+
+    // MODIFY: add a sorted run as the newest one, then merge the newest runs
+    //         while the older of two is less than twice the size of the newer
+    void addRun(std::vector<TYPE>&& run){
+        this->runs.push_back(std::move(run));
+        while(this->runs.size() > 1 &&
+              this->runs[this->runs.size() - 2].size() < 2 * this->runs.back().size()){
+            this->mergeRuns(this->runs.size() - 2);
+        }
+    }
+
+    // MODIFY: after runs[index] shrank, merge it with the newer runs while it
+    //         is less than twice the size of the next one, then merge the
+    //         grown run with the older runs while they are less than twice
+    //         its size
+    void restoreRuns(std::size_t index){
+        while(index + 1 < this->runs.size() &&
+              this->runs[index].size() < 2 * this->runs[index + 1].size()){
+            this->mergeRuns(index);
+        }
+        while(index > 0 && this->runs[index - 1].size() < 2 * this->runs[index].size()){
+            this->mergeRuns(--index);
+        }
+    }
+
+    // REQUIRE: runs[index + 1] exists
+    // MODIFY: merge runs[index] and the next newer run into runs[index]
+    void mergeRuns(std::size_t index) const {
+        std::vector<TYPE>& older = this->runs[index];
+        std::vector<TYPE>& newer = this->runs[index + 1];
+        std::vector<TYPE> merged;
+        merged.reserve(older.size() + newer.size());
+        std::merge(std::make_move_iterator(older.begin()), std::make_move_iterator(older.end()),
+                   std::make_move_iterator(newer.begin()), std::make_move_iterator(newer.end()),
+                   std::back_inserter(merged), this->compare);
+        older.swap(merged);
+        this->runs.erase(this->runs.begin() + static_cast<std::ptrdiff_t>(index) + 1);
+    }
+
+    // MODIFY: move every element to the end of all, leaving no runs and an
+    //         empty buffer
+    void moveAll(std::vector<TYPE>& all){
+        for(std::vector<TYPE>& run : this->runs){
+            std::move(run.begin(), run.end(), std::back_inserter(all));
+        }
+        std::move(this->buffer.begin(), this->buffer.end(), std::back_inserter(all));
+        this->runs.clear();
+        this->buffer.clear();
+    }
+
+    // REQUIRE: heap is not empty
+    // MODIFY: set extreme to where the most extreme element is
+    void findExtreme() const {
+        std::size_t best = this->runs.size();
+        for(std::size_t i = 0; i < this->runs.size(); ++i){
+            if(this->runs[i].empty()) continue;
+            if(best == this->runs.size() ?
+               (this->buffer.empty() || this->compare(this->buffer.back(), this->runs[i].back())) :
+               this->compare(this->runs[best].back(), this->runs[i].back())){
+                best = i;
+            }
+        }
+        this->extreme = best;
+    }
 
 }; // SortedPQ
 
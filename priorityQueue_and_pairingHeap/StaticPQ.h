@@ -0,0 +1,52 @@
+// Project identifier: 0E04A31E0D60C01986ACB20081C9D8722A1899B6
+
+#ifndef STATICPQ_H
+#define STATICPQ_H
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// Compile-time counterpart of the Eecs281PQ interface.
+//
+// Every priority queue in this directory is declared final, so a call made
+// through the concrete type (BinaryPQ<int>&, not Eecs281PQ<int>*) is bound
+// statically and the compiler can inline push()/pop()/top() together with the
+// comparator used inside them. Hot code picks the heap as a template
+// parameter and checks it with IsStaticPQ:
+//
+//     template<typename PQ>
+//     void drain(PQ& pq) {
+//         static_assert(IsStaticPQ<PQ>::value, "PQ must be a priority queue");
+//         while(!pq.empty()) pq.pop();
+//     }
+//
+//     BinaryPQ<int, std::less<int>, 4> heap;
+//     drain(heap);
+
+
+template<typename...>
+struct StaticPQVoid {
+    using type = void;
+};
+
+// EFFECT: IsStaticPQ<PQ>::value is true if PQ has value_type and the member
+//         functions push(const value_type&), pop(), top(), size(), empty()
+//         and updatePriorities() with the same meaning as in Eecs281PQ
+template<typename PQ, typename = void>
+struct IsStaticPQ : std::false_type {};
+
+template<typename PQ>
+struct IsStaticPQ<PQ, typename StaticPQVoid<
+    typename PQ::value_type,
+    decltype(std::declval<PQ&>().push(std::declval<const typename PQ::value_type&>())),
+    decltype(std::declval<PQ&>().pop()),
+    decltype(std::declval<PQ&>().updatePriorities())>::type> :
+    std::integral_constant<bool,
+        std::is_convertible<decltype(std::declval<const PQ&>().top()),
+                            const typename PQ::value_type&>::value &&
+        std::is_convertible<decltype(std::declval<const PQ&>().size()), std::size_t>::value &&
+        std::is_convertible<decltype(std::declval<const PQ&>().empty()), bool>::value> {};
+
+
+#endif // STATICPQ_H
@@ -0,0 +1,105 @@
+// Project identifier: 0E04A31E0D60C01986ACB20081C9D8722A1899B6
+
+#ifndef TOPK_H
+#define TOPK_H
+
+#include "BinaryPQ.h"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+
+// Turns a comparison functor around, so a heap ordered by it has the least
+// extreme element on top.
+template<typename TYPE, typename COMP_FUNCTOR>
+struct InvertedComp {
+    COMP_FUNCTOR compare;
+
+    bool operator()(const TYPE& a, const TYPE& b) const {
+        return compare(b, a);
+    }
+};
+
+
+// Keeps the K most extreme (defined by 'compare') elements of a stream. The
+// kept elements sit in a BinaryPQ of at most K elements with the comparison
+// inverted, so its top is the worst kept element. A new element that is not
+// better than that one is rejected after a single comparison, a better one
+// replaces it. Memory stays O(K) however long the stream is.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+class TopK {
+public:
+    // Description: Construct an empty selector for the k best elements.
+    // Runtime: O(1)
+    explicit TopK(std::size_t k, COMP_FUNCTOR comp = COMP_FUNCTOR()) :
+        compare{ comp }, limit{ k }, kept{ InvertedComp<TYPE, COMP_FUNCTOR>{ comp } } {
+    } // TopK()
+
+
+    // Description: Offer one element of the stream.
+    // EFFECT: return true if val is now one of the kept elements
+    // Runtime: O(1) if val is rejected, O(log(k)) otherwise
+    bool push(const TYPE& val) {
+        if(this->kept.size() < this->limit){
+            this->kept.push(val);
+            return true;
+        }
+        if(this->limit == 0 || !this->compare(this->kept.top(), val)) return false;
+        this->kept.replace_top(val);
+        return true;
+    } // push()
+
+
+    // Description: Offer all elements of an iterator range.
+    // Runtime: O(n) comparisons plus O(log(k)) for each kept element
+    template<typename InputIterator>
+    void push_batch(InputIterator start, InputIterator end) {
+        for(; start != end; ++start) this->push(*start);
+    } // push_batch()
+
+
+    // Description: Return the worst of the kept elements, the one a new
+    //              element has to beat once k elements are kept.
+    // REQUIRE: at least one element is kept
+    // Runtime: O(1)
+    const TYPE& threshold() const {
+        return this->kept.top();
+    } // threshold()
+
+
+    // Description: Get the number of kept elements, at most k.
+    // Runtime: O(1)
+    std::size_t size() const {
+        return this->kept.size();
+    } // size()
+
+
+    // Description: Return true if no element is kept.
+    // Runtime: O(1)
+    bool empty() const {
+        return this->kept.empty();
+    } // empty()
+
+
+    // Description: Move the kept elements out, most extreme first, and leave
+    //              the selector empty.
+    // Runtime: O(k log(k))
+    std::vector<TYPE> extract() {
+        std::vector<TYPE> result;
+        result.reserve(this->kept.size());
+        // the inverted heap hands out the worst element first
+        while(!this->kept.empty()) result.push_back(this->kept.pop_value());
+        std::reverse(result.begin(), result.end());
+        return result;
+    } // extract()
+
+
+private:
+    COMP_FUNCTOR compare;
+    std::size_t limit;
+    BinaryPQ<TYPE, InvertedComp<TYPE, COMP_FUNCTOR>> kept;
+}; // TopK
+
+#endif // TOPK_H
@@ -4,6 +4,7 @@
 #define UNORDEREDFASTPQ_H
 
 #include "Eecs281PQ.h"
+#include "FindExtreme.h"
 
 #include <limits>  // needed for UNKNOWN
 
@@ -23,7 +24,7 @@ static const size_t UNKNOWN = std::numeric_limits<size_t>::max();
 // are written, especially the use of this->compare.
 
 template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
-class UnorderedFastPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+class UnorderedFastPQ final : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
     // This is a way to refer to the base class object.
     using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
 
@@ -69,6 +70,15 @@ public:
     } // push()
 
 
+    // Description: Add all elements of an iterator range to the heap.
+    // Runtime: O(k) where k is number of elements in range.
+    template<typename InputIterator>
+    void push_range(InputIterator start, InputIterator end) {
+        data.insert(data.end(), start, end);
+        extreme = UNKNOWN;
+    } // push_range()
+
+
     // Description: Remove the most extreme (defined by 'compare') element from
     //              the heap.
     // Note: We will not run tests on your code that would require it to pop an
@@ -133,16 +143,11 @@ private:
 
     // Description: Find the 'most extreme' element of the data vector, using
     //              this->compare() to check if one element is 'less than'
-    //              another.
+    //              another. For int, float and double with std::less or
+    //              std::greater the search uses SIMD, see FindExtreme.h.
     // Runtime: O(n)
     void findExtreme() const {
-        size_t index = 0;
-
-        for (size_t i = 1; i < data.size(); ++i)
-            if (this->compare(data[index], data[i]))
-                index = i;
-
-        extreme = index;
+        extreme = ExtremeFinder<TYPE, COMP_FUNCTOR>::find(data, this->compare);
     } // findExtreme()
 }; // UnorderedFastPQ
 
@@ -0,0 +1,379 @@
+// Project identifier: 0E04A31E0D60C01986ACB20081C9D8722A1899B6
+
+/*
+ * Benchmarks of the priority queues on standard workloads:
+ *
+ *   hold      the hold model: n elements, then n times pop the top and push
+ *             it back with a random increment
+ *   heapsort  push n random elements, then pop all of them
+ *   bursty    bursts of random size that mostly push or mostly pop
+ *   dijkstra  shortest paths on a random sparse graph with n vertices. Heaps
+ *             with node handles lower a distance with updateElt(), the other
+ *             ones push a new entry and skip stale ones when they are popped
+ *
+ * For each heap, element type and size it prints nanoseconds per operation
+ * (a push, pop or update), comparator calls per operation and the peak heap
+ * memory in use during the run. The time and memory are measured with a
+ * plain std::greater, so they include no counting and the heaps keep their
+ * fast paths for it. The comparator calls are counted in a second, untimed
+ * run on the same random input with CountingComp.
+ *
+ * Build and run with 'make bench', or 'make bench.exe' and then
+ * './bench.exe [max n] [workload]'. The default max n is 100000. Sizes go up
+ * by factors of 10 from 1000, so './bench.exe 100000000' runs the largest
+ * sizes. UnorderedPQ and UnorderedFastPQ take O(n) per operation and are
+ * only run up to n = 10000.
+ */
+
+#include "BinaryPQ.h"
+#include "FibonacciPQ.h"
+#include "Instrument.h"
+#include "PairingPQ.h"
+#include "RankPairingPQ.h"
+#include "SortedPQ.h"
+#include "UnorderedFastPQ.h"
+#include "UnorderedPQ.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <new>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+
+// Heap memory accounting. Every allocation of the program goes through these
+// operators, which keep the size in front of the block.
+namespace {
+    size_t liveBytes = 0;
+    size_t peakBytes = 0;
+    const size_t HEADER = alignof(std::max_align_t) > sizeof(size_t) ? alignof(std::max_align_t) : sizeof(size_t);
+}
+
+void* operator new(size_t size) {
+    void* block = malloc(size + HEADER);
+    if(block == nullptr) throw bad_alloc();
+    *static_cast<size_t*>(block) = size;
+    liveBytes += size;
+    if(liveBytes > peakBytes) peakBytes = liveBytes;
+    return static_cast<char*>(block) + HEADER;
+}
+
+void operator delete(void* memory) noexcept {
+    if(memory == nullptr) return;
+    void* block = static_cast<char*>(memory) - HEADER;
+    liveBytes -= *static_cast<size_t*>(block);
+    free(block);
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete[](void* memory) noexcept {
+    operator delete(memory);
+}
+
+
+// Random elements of each type.
+mt19937_64 generator(281);
+
+template<typename TYPE>
+TYPE randomElt();
+
+template<>
+int randomElt<int>() {
+    return static_cast<int>(generator() % 1000000000);
+}
+
+template<>
+double randomElt<double>() {
+    return static_cast<double>(generator() % 1000000000) / 1000.0;
+}
+
+template<>
+string randomElt<string>() {
+    // a common prefix makes the comparisons look at more than one character
+    string s = "key-";
+    for(int i = 0; i < 12; ++i) s.push_back(static_cast<char>('a' + generator() % 26));
+    return s;
+}
+
+// EFFECT: return an element that is larger than val, for the hold model
+int increase(int val) { return val + static_cast<int>(generator() % 1000); }
+double increase(double val) { return val + static_cast<double>(generator() % 1000) / 1000.0; }
+string increase(const string& val) { return val + static_cast<char>('a' + generator() % 26); }
+
+
+// One measured run.
+struct Result {
+    double seconds;
+    uint64_t ops;
+    uint64_t compares;
+    size_t peak;
+};
+
+class Measure {
+public:
+    Measure() : startCompares{ compareCount() }, startLive{ liveBytes },
+        start{ chrono::steady_clock::now() } {
+        peakBytes = liveBytes;
+    }
+
+    Result stop(uint64_t ops) const {
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - this->start;
+        return Result{ elapsed.count(), ops, compareCount() - this->startCompares, peakBytes - this->startLive };
+    }
+
+private:
+    uint64_t startCompares;
+
+    // comparator calls are counted by CountingComp, see Instrument.h
+    static uint64_t compareCount() {
+        return InstrumentStats::global().total().compares;
+    }
+    size_t startLive;
+    chrono::steady_clock::time_point start;
+};
+
+
+// The heaps are min-heaps (std::greater), like the event and distance
+// queues of the workloads. Every heap is run with both comparators.
+template<typename TYPE>
+using MinComp = greater<TYPE>;
+template<typename TYPE>
+using CountedMinComp = CountingComp<greater<TYPE>>;
+
+// BinaryPQ with its default arity, to pass it like the other heaps
+template<typename TYPE, typename COMP_FUNCTOR>
+using BinaryHeap = BinaryPQ<TYPE, COMP_FUNCTOR>;
+
+template<typename PQ>
+Result holdModel(size_t n) {
+    using TYPE = typename PQ::value_type;
+    vector<TYPE> initial;
+    for(size_t i = 0; i < n; ++i) initial.push_back(randomElt<TYPE>());
+    Measure measure;
+    PQ pq;
+    for(const TYPE& val : initial) pq.push(val);
+    for(size_t i = 0; i < n; ++i){
+        TYPE next = increase(pq.top());
+        pq.pop();
+        pq.push(next);
+    }
+    return measure.stop(3 * n);
+}
+
+template<typename PQ>
+Result heapsort(size_t n) {
+    using TYPE = typename PQ::value_type;
+    vector<TYPE> values;
+    for(size_t i = 0; i < n; ++i) values.push_back(randomElt<TYPE>());
+    Measure measure;
+    PQ pq;
+    for(const TYPE& val : values) pq.push(val);
+    size_t index = 0;
+    while(!pq.empty()){
+        values[index++] = pq.top();
+        pq.pop();
+    }
+    return measure.stop(2 * n);
+}
+
+template<typename PQ>
+Result bursty(size_t n) {
+    using TYPE = typename PQ::value_type;
+    vector<TYPE> values;
+    for(size_t i = 0; i < n; ++i) values.push_back(randomElt<TYPE>());
+    Measure measure;
+    PQ pq;
+    uint64_t ops = 0;
+    size_t next = 0;
+    while(next < values.size() || !pq.empty()){
+        // a burst of up to 1% of n operations, 3 of 4 bursts push
+        size_t burst = 1 + generator() % (n / 100 + 1);
+        bool pushing = next < values.size() && (pq.empty() || generator() % 4 != 0);
+        for(size_t i = 0; i < burst; ++i, ++ops){
+            if(pushing && next < values.size()) pq.push(values[next++]);
+            else if(!pushing && !pq.empty()) pq.pop();
+            else break;
+        }
+    }
+    return measure.stop(ops);
+}
+
+
+// A random graph: vertex i has an edge to i + 1, so every vertex is reached,
+// and DEGREE - 1 edges to random vertices.
+struct Graph {
+    static const size_t DEGREE = 8;
+    vector<uint32_t> target;
+    vector<uint32_t> weight;
+
+    explicit Graph(size_t n) {
+        target.reserve(n * DEGREE);
+        weight.reserve(n * DEGREE);
+        for(size_t v = 0; v < n; ++v){
+            for(size_t e = 0; e < DEGREE; ++e){
+                target.push_back(static_cast<uint32_t>(e == 0 ? (v + 1) % n : generator() % n));
+                weight.push_back(static_cast<uint32_t>(1 + generator() % 1000));
+            }
+        }
+    }
+};
+
+using Entry = pair<uint64_t, uint32_t>;
+
+template<typename PQ>
+Result dijkstraLazy(size_t n) {
+    Graph graph(n);
+    vector<uint64_t> dist(n, numeric_limits<uint64_t>::max());
+    Measure measure;
+    PQ pq;
+    uint64_t ops = 1;
+    dist[0] = 0;
+    pq.push(Entry{ 0, 0 });
+    while(!pq.empty()){
+        Entry entry = pq.top();
+        pq.pop();
+        ++ops;
+        if(entry.first > dist[entry.second]) continue;
+        for(size_t e = entry.second * Graph::DEGREE; e < (entry.second + 1) * Graph::DEGREE; ++e){
+            uint64_t through = entry.first + graph.weight[e];
+            if(through < dist[graph.target[e]]){
+                dist[graph.target[e]] = through;
+                pq.push(Entry{ through, graph.target[e] });
+                ++ops;
+            }
+        }
+    }
+    return measure.stop(ops);
+}
+
+template<typename PQ>
+Result dijkstraHandles(size_t n) {
+    Graph graph(n);
+    vector<uint64_t> dist(n, numeric_limits<uint64_t>::max());
+    Measure measure;
+    PQ pq;
+    vector<typename PQ::Node*> nodes(n, nullptr);
+    vector<bool> done(n, false);
+    uint64_t ops = 1;
+    dist[0] = 0;
+    nodes[0] = pq.addNode(Entry{ 0, 0 });
+    while(!pq.empty()){
+        Entry entry = pq.top();
+        pq.pop();
+        ++ops;
+        done[entry.second] = true;
+        for(size_t e = entry.second * Graph::DEGREE; e < (entry.second + 1) * Graph::DEGREE; ++e){
+            uint32_t v = graph.target[e];
+            uint64_t through = entry.first + graph.weight[e];
+            if(done[v] || through >= dist[v]) continue;
+            dist[v] = through;
+            if(nodes[v] == nullptr) nodes[v] = pq.addNode(Entry{ through, v });
+            else pq.updateElt(nodes[v], Entry{ through, v });
+            ++ops;
+        }
+    }
+    return measure.stop(ops);
+}
+
+
+void report(const char* workload, const char* pq, const char* type, size_t n, const Result& result) {
+    printf("%-9s %-16s %-7s %10zu %10.1f %10.2f %12.1f\n", workload, pq, type, n,
+           result.seconds * 1e9 / static_cast<double>(result.ops),
+           static_cast<double>(result.compares) / static_cast<double>(result.ops),
+           static_cast<double>(result.peak) / 1024.0);
+    fflush(stdout);
+}
+
+// EFFECT: run timed, then counted on the same random numbers, and return
+//         the time and memory of the first with the comparisons of the second
+Result timedAndCounted(Result (*timed)(size_t), Result (*counted)(size_t), size_t n) {
+    uint64_t seed = generator();
+    generator.seed(seed);
+    Result result = timed(n);
+    generator.seed(seed);
+    result.compares = counted(n).compares;
+    return result;
+}
+
+// the heaps with O(n) operations are only run up to this size
+const size_t LINEAR_LIMIT = 10000;
+
+template<typename TYPE, template<typename, typename> class HEAP>
+void runHeap(const string& workload, const char* pq, const char* typeName, size_t n) {
+    using Timed = HEAP<TYPE, MinComp<TYPE>>;
+    using Counted = HEAP<TYPE, CountedMinComp<TYPE>>;
+    Result result;
+    if(workload == "hold") result = timedAndCounted(holdModel<Timed>, holdModel<Counted>, n);
+    else if(workload == "heapsort") result = timedAndCounted(heapsort<Timed>, heapsort<Counted>, n);
+    else result = timedAndCounted(bursty<Timed>, bursty<Counted>, n);
+    report(workload.c_str(), pq, typeName, n, result);
+}
+
+template<typename TYPE>
+void runType(const char* typeName, size_t n, const string& only) {
+    for(const string workload : { "hold", "heapsort", "bursty" }){
+        if(!only.empty() && only != workload) continue;
+        runHeap<TYPE, BinaryHeap>(workload, "BinaryPQ", typeName, n);
+        runHeap<TYPE, PairingPQ>(workload, "PairingPQ", typeName, n);
+        runHeap<TYPE, SortedPQ>(workload, "SortedPQ", typeName, n);
+        if(n <= LINEAR_LIMIT){
+            runHeap<TYPE, UnorderedPQ>(workload, "UnorderedPQ", typeName, n);
+            runHeap<TYPE, UnorderedFastPQ>(workload, "UnorderedFastPQ", typeName, n);
+        }
+        runHeap<TYPE, FibonacciPQ>(workload, "FibonacciPQ", typeName, n);
+        runHeap<TYPE, RankPairingPQ>(workload, "RankPairingPQ", typeName, n);
+    }
+}
+
+// Dijkstra with a heap without node handles, which pushes duplicates.
+template<template<typename, typename> class HEAP>
+void runDijkstraLazy(const char* pq, size_t n) {
+    report("dijkstra", pq, "uint64", n, timedAndCounted(dijkstraLazy<HEAP<Entry, MinComp<Entry>>>,
+                                                        dijkstraLazy<HEAP<Entry, CountedMinComp<Entry>>>, n));
+}
+
+// Dijkstra with a heap that lowers distances through node handles.
+template<template<typename, typename> class HEAP>
+void runDijkstraHandles(const char* pq, size_t n) {
+    report("dijkstra", pq, "uint64", n, timedAndCounted(dijkstraHandles<HEAP<Entry, MinComp<Entry>>>,
+                                                        dijkstraHandles<HEAP<Entry, CountedMinComp<Entry>>>, n));
+}
+
+void runDijkstra(size_t n) {
+    runDijkstraLazy<BinaryHeap>("BinaryPQ", n);
+    runDijkstraHandles<PairingPQ>("PairingPQ", n);
+    runDijkstraLazy<SortedPQ>("SortedPQ", n);
+    if(n <= LINEAR_LIMIT){
+        runDijkstraLazy<UnorderedPQ>("UnorderedPQ", n);
+        runDijkstraLazy<UnorderedFastPQ>("UnorderedFastPQ", n);
+    }
+    runDijkstraHandles<FibonacciPQ>("FibonacciPQ", n);
+    runDijkstraHandles<RankPairingPQ>("RankPairingPQ", n);
+}
+
+
+int main(int argc, char* argv[]) {
+    size_t maxN = (argc > 1) ? static_cast<size_t>(strtoull(argv[1], nullptr, 10)) : 100000;
+    string only = (argc > 2) ? argv[2] : "";
+
+    printf("%-9s %-16s %-7s %10s %10s %10s %12s\n", "workload", "pq", "type", "n",
+           "ns/op", "cmp/op", "peak KiB");
+    for(size_t n = 1000; n <= maxN; n *= 10){
+        runType<int>("int", n, only);
+        runType<double>("double", n, only);
+        runType<string>("string", n, only);
+        if(only.empty() || only == "dijkstra") runDijkstra(n);
+    }
+    return 0;
+}
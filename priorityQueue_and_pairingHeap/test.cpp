@@ -1,14 +1,670 @@
 #include "PairingPQ.h"
+#include "RadixPQ.h"
+#include "RankPairingPQ.h"
+#include "BinaryPQ.h"
+#include "ExternalPQ.h"
+#include "FibonacciPQ.h"
+#include "FindExtreme.h"
+#include "IndexedBinaryPQ.h"
+#include "Instrument.h"
+#include "MinMaxPQ.h"
+#include "MultiQueuePQ.h"
+#include "SortedPQ.h"
+#include "StaticPQ.h"
+#include "TopK.h"
+#include "UnorderedFastPQ.h"
+#include "UnorderedPQ.h"
 #include <cassert>
+#include <limits>
 #include <iostream>
 #include <vector>
 #include <numeric>
+#include <algorithm>
 #include <queue>
+#include <set>
+#include <iterator>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
 
 
 using namespace std;
 
 
+static_assert(IsStaticPQ<BinaryPQ<int>>::value, "BinaryPQ");
+static_assert(IsStaticPQ<BinaryPQ<int, std::greater<int>, 4>>::value, "4-ary BinaryPQ");
+static_assert(IsStaticPQ<IndexedBinaryPQ<int>>::value, "IndexedBinaryPQ");
+static_assert(IsStaticPQ<PairingPQ<int>>::value, "PairingPQ");
+static_assert(IsStaticPQ<FibonacciPQ<int>>::value, "FibonacciPQ");
+static_assert(IsStaticPQ<RankPairingPQ<int>>::value, "RankPairingPQ");
+static_assert(IsStaticPQ<SortedPQ<int>>::value, "SortedPQ");
+static_assert(IsStaticPQ<UnorderedPQ<int>>::value, "UnorderedPQ");
+static_assert(IsStaticPQ<UnorderedFastPQ<int>>::value, "UnorderedFastPQ");
+static_assert(IsStaticPQ<RadixPQ<unsigned>>::value, "RadixPQ");
+static_assert(IsStaticPQ<MinMaxPQ<int>>::value, "MinMaxPQ");
+static_assert(!IsStaticPQ<vector<int>>::value, "vector is not a PQ");
+
+// pop every element out of pq and check they come out in order
+template<typename PQ>
+void checkDrain(PQ& pq, vector<int> expect){
+    static_assert(IsStaticPQ<PQ>::value, "PQ must be a priority queue");
+    sort(expect.begin(), expect.end());
+    while(!expect.empty()){
+        assert(pq.size() == expect.size());
+        assert(pq.top() == expect.back());
+        pq.pop();
+        expect.pop_back();
+    }
+    assert(pq.empty());
+}
+
+template<size_t ARITY>
+void testDaryHeap(){
+    vector<int> a;
+    for(int i = 0; i < 500; ++i) a.push_back(rand() % 100);
+    BinaryPQ<int, std::less<int>, ARITY> fromRange(a.begin(), a.end());
+    checkDrain(fromRange, a);
+
+    BinaryPQ<int, std::less<int>, ARITY> byPush;
+    for(int x : a) byPush.push(x);
+    checkDrain(byPush, a);
+}
+
+struct UniquePtrComp {
+    bool operator()(const unique_ptr<int>& a, const unique_ptr<int>& b) const {
+        return *a < *b;
+    }
+};
+
+void testMoveOnly(){
+    BinaryPQ<unique_ptr<int>, UniquePtrComp> pq;
+    for(int i = 0; i < 50; ++i) pq.push(unique_ptr<int>(new int((i * 37) % 50)));
+    pq.emplace(new int(100));
+    assert(pq.size() == 51 && *pq.top() == 100);
+    for(int expect = 100; !pq.empty(); expect = (expect == 100) ? 49 : expect - 1){
+        unique_ptr<int> p = pq.pop_value();
+        assert(*p == expect);
+    }
+    // copying push through the Eecs281PQ interface can't work and must say so
+    pq.push(unique_ptr<int>(new int(1)));
+    Eecs281PQ<unique_ptr<int>, UniquePtrComp>& base = pq;
+    unique_ptr<int> other(new int(2));
+    bool threw = false;
+    try{
+        base.push(other);
+    }
+    catch(const std::logic_error&){
+        threw = true;
+    }
+    assert(threw && pq.size() == 1 && other != nullptr);
+
+    BinaryPQ<string, std::less<string>, 4> strings;
+    string longWord(100, 'z');
+    strings.push(string("apple"));
+    strings.emplace(3, 'b');
+    strings.push(longWord);
+    assert(strings.pop_value() == longWord);
+    assert(strings.pop_value() == "bbb");
+    assert(strings.pop_value() == "apple" && strings.empty());
+}
+
+void testIndexedHeap(){
+    // keep a plain copy of every live element and compare after each change
+    vector<int> values;
+    vector<bool> alive;
+    IndexedBinaryPQ<int> pq;
+    for(int i = 0; i < 200; ++i){
+        IndexedBinaryPQ<int>::Handle h = pq.addElt(rand() % 1000);
+        assert(h == values.size());
+        values.push_back(pq.getElt(h));
+        alive.push_back(true);
+    }
+    for(int round = 0; round < 400; ++round){
+        size_t h = rand() % values.size();
+        if(!alive[h]) continue;
+        if(round % 3 == 0){
+            pq.erase(h);
+            alive[h] = false;
+            assert(!pq.contains(h));
+        }
+        else{
+            values[h] = rand() % 1000;
+            pq.updateElt(h, values[h]);
+        }
+        int best = -1;
+        for(size_t i = 0; i < values.size(); ++i){
+            if(alive[i]) best = max(best, values[i]);
+        }
+        assert(pq.top() == best && alive[pq.topHandle()]);
+    }
+    // a freed handle is reused by the next push
+    size_t freed = pq.topHandle();
+    pq.pop();
+    assert(pq.addElt(5) == freed && pq.getElt(freed) == 5);
+}
+
+struct IntPtrComp {
+    bool operator()(const int* a, const int* b) const {
+        return *a < *b;
+    }
+};
+
+void testPairingHeap(){
+    vector<int> a;
+    PairingPQ<int> pq;
+    for(int i = 0; i < 300; ++i){
+        a.push_back(rand() % 100);
+        pq.push(a.back());
+        // pop now and then so the tree gets some depth
+        if(i % 7 == 6){
+            sort(a.begin(), a.end());
+            assert(pq.top() == a.back());
+            pq.pop();
+            a.pop_back();
+        }
+    }
+    PairingPQ<int> copy(pq);
+    PairingPQ<int> assigned;
+    assigned.push(-1);
+    assigned = copy;
+    // the clone keeps working after its nodes are reused and merged away
+    sort(a.begin(), a.end());
+    copy.pop();
+    copy.push(a.back());
+    checkDrain(copy, a);
+    PairingPQ<int> merged(assigned);
+    merged.merge(std::move(assigned));
+    vector<int> twice(a);
+    twice.insert(twice.end(), a.begin(), a.end());
+    checkDrain(merged, twice);
+    checkDrain(pq, a);
+
+    vector<int> values(100);
+    iota(values.begin(), values.end(), 0);
+    PairingPQ<int*, IntPtrComp> ptrs;
+    for(int& v : values) ptrs.push(&v);
+    ptrs.pop();
+    random_shuffle(values.begin(), values.end());
+    ptrs.updatePriorities();
+    for(int expect = 99; expect >= 0; --expect){
+        if(values[99] == expect) continue;
+        assert(*ptrs.top() == expect);
+        ptrs.pop();
+    }
+    assert(ptrs.empty());
+}
+
+template<typename PQ>
+void testNodeHandles(){
+    // nodes[i] holds value values[i] until it is erased
+    PQ pq;
+    vector<typename PQ::Node*> nodes;
+    vector<int> values;
+    for(int i = 0; i < 200; ++i){
+        values.push_back(rand() % 1000);
+        nodes.push_back(pq.addNode(values.back()));
+    }
+    for(int round = 0; round < 300; ++round){
+        size_t i = rand() % nodes.size();
+        if(round % 4 == 0){
+            pq.erase(nodes[i]);
+            nodes.erase(nodes.begin() + i);
+            values.erase(values.begin() + i);
+        }
+        else{
+            // move priorities both up and down
+            values[i] = rand() % 1000;
+            pq.updateElt(nodes[i], values[i]);
+        }
+        assert(pq.top() == *max_element(values.begin(), values.end()));
+        assert(pq.size() == values.size());
+    }
+
+    PQ other;
+    vector<int> otherValues{ 5, 2000, 7 };
+    typename PQ::Node* moved = other.addNode(otherValues[0]);
+    other.push(otherValues[1]);
+    other.push(otherValues[2]);
+    pq.merge(std::move(other));
+    assert(other.empty() && pq.top() == 2000);
+    pq.updateElt(moved, 3000);
+    assert(pq.top() == 3000);
+    values.insert(values.end(), otherValues.begin(), otherValues.end());
+    values[values.size() - 3] = 3000;
+    checkDrain(pq, values);
+}
+
+// copies and rebuilds of the heaps that hand out nodes
+template<typename PQ, typename PtrPQ>
+void testNodeHeapCopy(){
+    vector<int> a;
+    PQ pq;
+    for(int i = 0; i < 300; ++i){
+        a.push_back(rand() % 100);
+        pq.push(a.back());
+        if(i % 7 == 6){
+            sort(a.begin(), a.end());
+            assert(pq.top() == a.back());
+            pq.pop();
+            a.pop_back();
+        }
+    }
+    PQ copy(pq);
+    PQ assigned;
+    assigned.push(-1);
+    assigned = copy;
+    checkDrain(copy, a);
+    checkDrain(assigned, a);
+    checkDrain(pq, a);
+
+    // handles stay valid when the priorities are rebuilt
+    vector<int> values(100);
+    iota(values.begin(), values.end(), 0);
+    PtrPQ ptrs;
+    vector<typename PtrPQ::Node*> nodes;
+    for(int& v : values) nodes.push_back(ptrs.addNode(&v));
+    ptrs.pop();
+    random_shuffle(values.begin(), values.end());
+    ptrs.updatePriorities();
+    ptrs.erase(nodes[0]);
+    for(int expect = 99; expect >= 0; --expect){
+        if(values[99] == expect || values[0] == expect) continue;
+        assert(*ptrs.top() == expect);
+        ptrs.pop();
+    }
+    assert(ptrs.empty());
+}
+
+// An element that counts its live copies and can be told to fail copying.
+struct ThrowingCopy {
+    int value;
+    static int live;
+    // copies left before the next one throws, negative for never
+    static int copiesLeft;
+
+    explicit ThrowingCopy(int v) : value{ v } { ++live; }
+    ThrowingCopy(const ThrowingCopy& other) : value{ other.value } {
+        if(copiesLeft == 0) throw runtime_error("copy failed");
+        if(copiesLeft > 0) --copiesLeft;
+        ++live;
+    }
+    ~ThrowingCopy() { --live; }
+    bool operator<(const ThrowingCopy& other) const { return this->value < other.value; }
+};
+int ThrowingCopy::live = 0;
+int ThrowingCopy::copiesLeft = -1;
+
+// a copy constructor that fails halfway destroys what it copied
+template<typename PQ>
+void testCopyThrows(){
+    {
+        PQ pq;
+        for(int i = 0; i < 100; ++i) pq.push(ThrowingCopy((i * 37) % 100));
+        pq.pop();
+        int before = ThrowingCopy::live;
+        ThrowingCopy::copiesLeft = 60;
+        bool threw = false;
+        try{
+            PQ copy(pq);
+        }
+        catch(const runtime_error&){
+            threw = true;
+        }
+        ThrowingCopy::copiesLeft = -1;
+        assert(threw && ThrowingCopy::live == before);
+        PQ copy(pq);
+        assert(copy.size() == 99 && copy.top().value == 98);
+    }
+    assert(ThrowingCopy::live == 0);
+}
+
+// a push_range() that fails halfway leaves the heap as it was
+void testPushRangeThrows(){
+    {
+        PairingPQ<ThrowingCopy> pq;
+        for(int i = 0; i < 10; ++i) pq.push(ThrowingCopy(i));
+        vector<ThrowingCopy> batch;
+        for(int i = 10; i < 20; ++i) batch.push_back(ThrowingCopy(i));
+        int before = ThrowingCopy::live;
+        ThrowingCopy::copiesLeft = 5;
+        bool threw = false;
+        try{
+            pq.push_range(batch.begin(), batch.end());
+        }
+        catch(const runtime_error&){
+            threw = true;
+        }
+        ThrowingCopy::copiesLeft = -1;
+        assert(threw && ThrowingCopy::live == before && pq.size() == 10);
+        for(int expect = 9; expect >= 0; --expect){
+            assert(pq.top().value == expect);
+            pq.pop();
+        }
+        assert(pq.empty());
+    }
+    assert(ThrowingCopy::live == 0);
+}
+
+template<typename PQ>
+void testPushRange(){
+    // a small batch into a big heap is fixed up, a big batch rebuilds
+    vector<int> all;
+    PQ pq;
+    for(size_t batch : { 1, 200, 3, 0, 1000, 10 }){
+        vector<int> values;
+        for(size_t i = 0; i < batch; ++i) values.push_back(rand() % 500);
+        pq.push_range(values.begin(), values.end());
+        all.insert(all.end(), values.begin(), values.end());
+        assert(pq.size() == all.size());
+    }
+    checkDrain(pq, all);
+}
+
+struct DistanceKey {
+    unsigned long long operator()(const pair<unsigned long long, int>& entry) const {
+        return entry.first;
+    }
+};
+
+void testRadixHeap(){
+    // a Dijkstra-like run: new keys are never below the last popped one
+    RadixPQ<pair<unsigned long long, int>, DistanceKey> pq;
+    std::priority_queue<unsigned long long, vector<unsigned long long>,
+                        std::greater<unsigned long long>> reference;
+    unsigned long long current = 0;
+    for(int round = 0; round < 2000; ++round){
+        if(round % 3 != 2 || pq.empty()){
+            unsigned long long key = current + (rand() % 4 == 0 ? 0 : rand() % 100000);
+            pq.push(make_pair(key, round));
+            reference.push(key);
+        }
+        else{
+            assert(pq.top().first == reference.top());
+            current = pq.top().first;
+            pq.pop();
+            reference.pop();
+        }
+        assert(pq.size() == reference.size());
+    }
+
+    vector<unsigned char> bytes{ 200, 3, 255, 3, 0, 17 };
+    RadixPQ<unsigned char> small(bytes.begin(), bytes.end());
+    sort(bytes.begin(), bytes.end());
+    for(unsigned char b : bytes){
+        assert(small.top() == b);
+        small.pop();
+    }
+    assert(small.empty());
+}
+
+void testMultiQueue(){
+    // every thread pushes its own range of numbers and pops as many elements
+    // as it pushed, all of them must come out exactly once. Then they push one
+    // and try to pop two at a time, so the queue stays nearly empty and pops
+    // often scan all shards while other threads hold some of them
+    const int threadCount = 4;
+    const int perThread = 2000;
+    MultiQueuePQ<int> pq(threadCount);
+    vector<vector<int>> popped(threadCount);
+    vector<thread> workers;
+    for(int t = 0; t < threadCount; ++t){
+        workers.push_back(thread([&pq, &popped, t, perThread](){
+            for(int i = 0; i < perThread / 2; ++i) pq.push(t * perThread + i);
+            int value;
+            for(int i = 0; i < perThread / 2; ++i){
+                if(pq.try_pop(value)) popped[t].push_back(value);
+            }
+            for(int i = perThread / 2; i < perThread; ++i){
+                pq.push(t * perThread + i);
+                if(pq.try_pop(value)) popped[t].push_back(value);
+                if(pq.try_pop(value)) popped[t].push_back(value);
+            }
+        }));
+    }
+    for(thread& worker : workers) worker.join();
+    vector<int> all;
+    for(vector<int>& part : popped) all.insert(all.end(), part.begin(), part.end());
+    int value;
+    while(pq.try_pop(value)) all.push_back(value);
+    assert(pq.empty());
+    sort(all.begin(), all.end());
+    for(int i = 0; i < threadCount * perThread; ++i) assert(all[i] == i);
+
+    // with a single shard nothing is relaxed, the order is exact
+    MultiQueuePQ<int> single(1, 1);
+    for(int i = 0; i < 1000; ++i) single.push((i * 37) % 1000);
+    for(int expect = 999; expect >= 0; --expect){
+        assert(single.try_pop(value) && value == expect);
+    }
+    assert(!single.try_pop(value) && single.empty());
+}
+
+void testExternalHeap(){
+    // a tiny memory limit forces many runs on disk, and many merges of runs
+    ExternalPQ<int> pq(64, 16);
+    multiset<int> all;
+    for(int round = 0; round < 40000; ++round){
+        if(round % 4 == 3){
+            assert(pq.top() == *all.rbegin());
+            pq.pop();
+            all.erase(prev(all.end()));
+        }
+        else{
+            int value = rand() % 10000;
+            all.insert(value);
+            pq.push(value);
+        }
+        // about 300 spills, so at most FAN_IN - 1 runs on each of 3 levels
+        assert(pq.runCount() < 3 * ExternalPQ<int>::FAN_IN);
+    }
+    assert(pq.runCount() > 1);
+    for(; !all.empty(); all.erase(prev(all.end()))){
+        assert(pq.size() == all.size() && pq.top() == *all.rbegin());
+        pq.pop();
+    }
+    assert(pq.empty());
+}
+
+void testTopK(){
+    vector<int> stream;
+    for(int i = 0; i < 5000; ++i) stream.push_back(rand() % 100000);
+    TopK<int> best(10);
+    best.push_batch(stream.begin(), stream.end());
+    assert(best.size() == 10);
+    vector<int> result = best.extract();
+    sort(stream.rbegin(), stream.rend());
+    assert(equal(result.begin(), result.end(), stream.begin()));
+    assert(best.empty());
+
+    // with std::greater the smallest elements are kept
+    TopK<int, std::greater<int>> smallest(3);
+    for(int x : { 5, 1, 9, 3, 7, 2 }) smallest.push(x);
+    assert(smallest.threshold() == 3);
+    assert(!smallest.push(4) && smallest.push(0));
+    vector<int> expect{ 0, 1, 2 };
+    assert(smallest.extract() == expect);
+
+    TopK<int> none(0);
+    assert(!none.push(1) && none.empty());
+
+    // elements without a default constructor
+    {
+        TopK<ThrowingCopy> noDefault(2);
+        for(int x : { 4, 8, 1, 6 }) noDefault.push(ThrowingCopy(x));
+        vector<ThrowingCopy> best = noDefault.extract();
+        assert(best.size() == 2 && best[0].value == 8 && best[1].value == 6);
+    }
+    assert(ThrowingCopy::live == 0);
+}
+
+void testMinMaxHeap(){
+    // remove from both ends at random and compare with a sorted copy
+    vector<int> values;
+    for(int i = 0; i < 300; ++i) values.push_back(rand() % 1000);
+    MinMaxPQ<int> pq(values.begin(), values.end());
+    for(int round = 0; round < 1000; ++round){
+        int choice = rand() % 3;
+        if(choice == 0 || values.empty()){
+            values.push_back(rand() % 1000);
+            pq.push(values.back());
+            continue;
+        }
+        sort(values.begin(), values.end());
+        assert(pq.top_max() == values.back() && pq.top_min() == values.front());
+        if(choice == 1){
+            pq.pop_max();
+            values.pop_back();
+        }
+        else{
+            pq.pop_min();
+            values.erase(values.begin());
+        }
+        assert(pq.size() == values.size());
+    }
+    checkDrain(pq, values);
+
+    MinMaxPQ<int, std::greater<int>> reversed;
+    for(int x : { 4, 8, 1, 6 }) reversed.push(x);
+    assert(reversed.top_max() == 1 && reversed.top_min() == 8);
+}
+
+void testSortedRuns(){
+    // enough pushes to create several runs of different sizes
+    SortedPQ<int> pq;
+    vector<int> values;
+    for(int round = 0; round < 3000; ++round){
+        if(round % 5 == 4){
+            sort(values.begin(), values.end());
+            assert(pq.top() == values.back());
+            pq.pop();
+            values.pop_back();
+        }
+        else{
+            values.push_back(rand() % 10000);
+            pq.push(values.back());
+        }
+    }
+    sort(values.begin(), values.end());
+    assert(pq.sorted() == values);
+    pq.push(-1);
+    values.insert(values.begin(), -1);
+    assert(pq.sorted() == values);
+    checkDrain(pq, values);
+    assert(pq.sorted().empty() && pq.runCount() == 0);
+
+    // runs of halving sizes that each hold one small element: popping all
+    // large elements must not leave one run per small element
+    SortedPQ<int> shrinking;
+    int large = 0;
+    for(int bits = 14; bits >= 0; --bits){
+        vector<int> run{ -bits };
+        for(int i = 1; i < 1 << bits; ++i) run.push_back(++large);
+        shrinking.push_range(run.begin(), run.end());
+    }
+    assert(shrinking.runCount() == 15);
+    for(; large > 0; --large){
+        assert(shrinking.top() == large);
+        shrinking.pop();
+        size_t bound = 1;
+        for(size_t n = shrinking.size(); n > 1; n /= 2) bound++;
+        assert(shrinking.runCount() <= bound);
+    }
+    assert(shrinking.size() == 15 && shrinking.top() == 0);
+}
+
+template<typename TYPE, typename COMP>
+void checkFindExtreme(const vector<TYPE>& data){
+    COMP compare;
+    size_t index = 0;
+    for(size_t i = 1; i < data.size(); ++i){
+        if(compare(data[index], data[i])) index = i;
+    }
+    assert((ExtremeFinder<TYPE, COMP>::find(data, compare) == index));
+}
+
+template<typename TYPE>
+void testFindExtremeType(){
+    // every length around the vector widths, with many ties for the first index
+    for(size_t n = 1; n < 100; ++n){
+        vector<TYPE> data;
+        for(size_t i = 0; i < n; ++i) data.push_back(static_cast<TYPE>(rand() % 20) - 10);
+        checkFindExtreme<TYPE, std::less<TYPE>>(data);
+        checkFindExtreme<TYPE, std::greater<TYPE>>(data);
+    }
+}
+
+void testFindExtreme(){
+    testFindExtremeType<int>();
+    testFindExtremeType<float>();
+    testFindExtremeType<double>();
+
+    vector<double> withNan(50, 1.0);
+    withNan[0] = std::numeric_limits<double>::quiet_NaN();
+    withNan[30] = 2.0;
+    checkFindExtreme<double, std::less<double>>(withNan);
+
+    vector<int> b;
+    for(int i = 0; i < 1000; ++i) b.push_back(rand());
+    UnorderedFastPQ<int, std::greater<int>> unorderedFast(b.begin(), b.end());
+    sort(b.begin(), b.end());
+    for(int x : b){
+        assert(unorderedFast.top() == x);
+        unorderedFast.pop();
+    }
+    assert(unorderedFast.empty());
+}
+
+
+void testInstrument(){
+    InstrumentStats& stats = InstrumentStats::global();
+    stats.reset();
+    InstrumentedPQ<BinaryPQ<Counted<int>>> pq;
+    for(int i = 0; i < 100; ++i) pq.push(Counted<int>(i));
+    while(!pq.empty()) pq.pop();
+    // pushing in increasing order moves each element to the top
+    OpStats push = stats.get("push");
+    assert(push.calls == 100 && push.compares > 100 && push.moves > 0);
+    assert(stats.get("pop").calls == 100 && stats.get("pop").compares > 0);
+    assert(stats.get("top").calls == 0);
+
+    // Counted moves are noexcept, so a growing vector moves its elements
+    stats.reset();
+    {
+        vector<Counted<int>> grow;
+        for(int i = 0; i < 100; ++i) grow.push_back(Counted<int>(i));
+    }
+    assert(stats.get("other").copies == 0 && stats.get("other").moves > 100);
+
+    stats.reset();
+    vector<int> values{ 5, 1, 4 };
+    InstrumentedPQ<PairingPQ<int, CountingComp<std::less<int>>>> counted(values.begin(), values.end());
+    assert(counted.top() == 5);
+    assert(stats.get("construct").compares == 2 && stats.get("top").calls == 1);
+    {
+        InstrumentStats::Scope scope("handles");
+        counted.inner().updateElt(counted.inner().addNode(0), 7);
+    }
+    assert(stats.get("handles").compares == 3 && counted.top() == 7);
+    assert(stats.total().compares == 5);
+}
+
+
+template<size_t ARITY>
+void testParallelBuild(){
+    // big enough for the threads to split the heap into subtrees
+    vector<int> values;
+    for(int i = 0; i < 200000; ++i) values.push_back(rand());
+    BinaryPQ<int, std::less<int>, ARITY> pq(values.begin(), values.end(), std::less<int>(), 4);
+    vector<int> copy(values);
+    BinaryPQ<int, std::less<int>, ARITY> rebuilt(pq);
+    rebuilt.updatePriorities(3);
+    rebuilt.updatePriorities(0);
+    checkDrain(pq, values);
+    checkDrain(rebuilt, copy);
+}
+
 
 int main(){
     vector<int> a{15,65,852,412,647,9};
@@ -21,5 +677,46 @@ int main(){
     test.push(85412);
     assert(test.top() == 85412);
     
-    
-}
\ No newline at end of file
+    testDaryHeap<2>();
+    testDaryHeap<3>();
+    testDaryHeap<4>();
+    testDaryHeap<8>();
+    testParallelBuild<2>();
+    testParallelBuild<4>();
+    testMoveOnly();
+    testIndexedHeap();
+    testPairingHeap();
+    testCopyThrows<PairingPQ<ThrowingCopy>>();
+    testPushRangeThrows();
+    testCopyThrows<FibonacciPQ<ThrowingCopy>>();
+    testCopyThrows<RankPairingPQ<ThrowingCopy>>();
+    testNodeHandles<PairingPQ<int>>();
+    testNodeHandles<FibonacciPQ<int>>();
+    testNodeHandles<RankPairingPQ<int>>();
+    testNodeHeapCopy<FibonacciPQ<int>, FibonacciPQ<int*, IntPtrComp>>();
+    testNodeHeapCopy<RankPairingPQ<int>, RankPairingPQ<int*, IntPtrComp>>();
+    testFindExtreme();
+    testInstrument();
+
+    vector<int> b;
+    for(int i = 0; i < 100; ++i) b.push_back(rand() % 50);
+    SortedPQ<int> sorted(b.begin(), b.end());
+    checkDrain(sorted, b);
+    UnorderedPQ<int> unordered(b.begin(), b.end());
+    checkDrain(unordered, b);
+    UnorderedFastPQ<int> unorderedFast(b.begin(), b.end());
+    checkDrain(unorderedFast, b);
+
+    testPushRange<BinaryPQ<int>>();
+    testPushRange<BinaryPQ<int, std::less<int>, 4>>();
+    testPushRange<PairingPQ<int>>();
+    testPushRange<SortedPQ<int>>();
+    testPushRange<UnorderedPQ<int>>();
+    testPushRange<UnorderedFastPQ<int>>();
+    testRadixHeap();
+    testMultiQueue();
+    testExternalHeap();
+    testTopK();
+    testMinMaxHeap();
+    testSortedRuns();
+}
@@ -0,0 +1,465 @@
+#define SORT_TEST
+#include "Sort.cpp"
+#include <cassert>
+#include <cstdlib>
+
+
+struct PairKeyComp {
+    bool operator()(const pair<int, int>& a, const pair<int, int>& b) const {
+        return a.first < b.first;
+    }
+};
+
+struct UniquePtrComp {
+    bool operator()(const unique_ptr<int>& a, const unique_ptr<int>& b) const {
+        return *a < *b;
+    }
+};
+
+// sum [first, last) by splitting it in halves with nested invoke() calls
+long long poolSum(WorkStealingPool& pool, const int* first, const int* last){
+    if(last - first <= 4){
+        long long sum = 0;
+        for(; first != last; ++first) sum += *first;
+        return sum;
+    }
+    const int* mid = first + (last - first) / 2;
+    long long left = 0;
+    long long right = 0;
+    pool.invoke([&](){ left = poolSum(pool, first, mid); },
+                [&](){ right = poolSum(pool, mid, last); });
+    return left + right;
+}
+
+void testWorkStealingPool(size_t threads){
+    WorkStealingPool pool(threads);
+    vector<int> values(10000);
+    for(size_t i = 0; i < values.size(); ++i) values[i] = rand() % 1000;
+    long long expect = 0;
+    for(int x : values) expect += x;
+    assert(poolSum(pool, values.data(), values.data() + values.size()) == expect);
+
+    // threads outside the pool can use it at the same time
+    long long sums[2] = { 0, 0 };
+    thread other([&](){ sums[0] = poolSum(pool, values.data(), values.data() + values.size()); });
+    sums[1] = poolSum(pool, values.data(), values.data() + values.size());
+    other.join();
+    assert(sums[0] == expect && sums[1] == expect);
+}
+
+void testParallelSorts(size_t threads){
+    WorkStealingPool pool(threads);
+    for(ptrdiff_t cutoff : { 0, 1, 2, 3, 16, 8192 }){
+        for(size_t n : { 0, 1, 2, 3, 17, 3000 }){
+            // few distinct keys, so stability is visible
+            vector<pair<int, int>> stable;
+            for(size_t i = 0; i < n; ++i) stable.push_back(make_pair(rand() % 10, static_cast<int>(i)));
+            vector<pair<int, int>> expect(stable);
+            std::stable_sort(expect.begin(), expect.end(), PairKeyComp());
+            parallelMergeSort(stable.begin(), stable.end(), PairKeyComp(), pool, cutoff);
+            assert(stable == expect);
+
+            vector<int> values;
+            for(size_t i = 0; i < n; ++i) values.push_back(rand() % 100);
+            vector<int> sorted(values);
+            std::sort(sorted.begin(), sorted.end());
+            parallelQuickSort(values.begin(), values.end(), std::less<int>(), pool, cutoff);
+            assert(values == sorted);
+
+            // move-only elements
+            vector<unique_ptr<int>> merged;
+            vector<unique_ptr<int>> quick;
+            for(int x : sorted){
+                merged.emplace_back(new int(x));
+                quick.emplace_back(new int(x));
+            }
+            std::random_shuffle(merged.begin(), merged.end());
+            std::random_shuffle(quick.begin(), quick.end());
+            parallelMergeSort(merged.begin(), merged.end(), UniquePtrComp(), pool, cutoff);
+            parallelQuickSort(quick.begin(), quick.end(), UniquePtrComp(), pool, cutoff);
+            for(size_t i = 0; i < n; ++i){
+                assert(*merged[i] == sorted[i] && *quick[i] == sorted[i]);
+            }
+        }
+    }
+}
+
+struct SecondKey {
+    const string& operator()(const pair<int, string>& element) const {
+        return element.second;
+    }
+};
+
+void testStringRadixSort(){
+    // nested prefixes "a", "aa", ... differ only at their last character, one
+    // call per character would overflow the stack. Their distinguishing
+    // prefixes add up to n^2 / 2 characters, so n stays moderate
+    vector<string> nested;
+    for(size_t length = 1; length <= 10000; ++length) nested.push_back(string(length, 'a'));
+    vector<string> expect(nested);
+    std::random_shuffle(nested.begin(), nested.end());
+    stringRadixSort(nested.begin(), nested.end());
+    assert(nested == expect);
+
+    // random keys with shared prefixes, sorted stably by key
+    vector<pair<int, string>> records;
+    for(int i = 0; i < 20000; ++i){
+        string key(static_cast<size_t>(rand() % 12), 'x');
+        for(char& c : key) c = static_cast<char>("ab\xff"[rand() % 3]);
+        records.push_back(make_pair(i, key));
+    }
+    vector<pair<int, string>> stable(records);
+    std::stable_sort(stable.begin(), stable.end(),
+                     [](const pair<int, string>& a, const pair<int, string>& b){ return a.second < b.second; });
+    stringRadixSort(records.begin(), records.end(), SecondKey());
+    assert(records == stable);
+}
+
+// EFFECT: return a random element with many duplicates, and now and then the
+//         smallest or largest value, infinities for floating point types
+template<typename TYPE>
+TYPE networkValue(){
+    using Limits = numeric_limits<TYPE>;
+    switch(rand() % 16){
+    case 0: return Limits::has_infinity ? Limits::infinity() : Limits::max();
+    case 1: return Limits::has_infinity ? -Limits::infinity() : Limits::lowest();
+    default: return static_cast<TYPE>(rand() % 9 - 4) / static_cast<TYPE>(2);
+    }
+}
+
+// EFFECT: return true if the network should accept a block of size elements
+template<typename TYPE, typename COMP>
+bool networkSorts(size_t size){
+#if defined(SORTING_NETWORK_AVX2)
+    return SortingNetwork<TYPE, COMP>::ENABLED && size <= SortingNetwork<TYPE, COMP>::MAX_SIZE &&
+           __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+template<typename TYPE, typename COMP>
+void testNetworkType(){
+    using Network = SortingNetwork<TYPE, COMP>;
+    // every block size the network pads, and sizes it must refuse
+    for(size_t size = 0; size <= 80; ++size){
+        for(int round = 0; round < 20; ++round){
+            vector<TYPE> values;
+            for(size_t i = 0; i < size; ++i) values.push_back(networkValue<TYPE>());
+            vector<TYPE> expect(values);
+            std::sort(expect.begin(), expect.end(), COMP());
+            vector<TYPE> block(values);
+            bool sorted = Network::sort(block.data(), size);
+            bool expectSorted = networkSorts<TYPE, COMP>(size);
+            assert(sorted == expectSorted);
+            assert(block == (sorted ? expect : values));
+
+            // through the sorts that use the network
+            vector<TYPE> quick(values);
+            quickSort(quick.begin(), quick.end(), COMP());
+            assert(quick == expect);
+            vector<TYPE> merged(values);
+            mergeSort(merged.begin(), merged.end(), COMP());
+            assert(merged == expect);
+        }
+    }
+}
+
+// a negative and a positive zero compare equal but can be told apart
+struct ZeroTag {
+    template<typename TYPE>
+    bool operator()(TYPE a, TYPE b) const {
+        return memcmp(&a, &b, sizeof(TYPE)) == 0;
+    }
+};
+
+template<typename TYPE, typename COMP>
+void testNetworkRefuses(){
+    using Network = SortingNetwork<TYPE, COMP>;
+    for(size_t size = 1; size <= 64; size *= 2){
+        for(TYPE odd : { -TYPE(0), numeric_limits<TYPE>::quiet_NaN() }){
+            vector<TYPE> values;
+            for(size_t i = 0; i < size; ++i) values.push_back(networkValue<TYPE>());
+            values[static_cast<size_t>(rand()) % size] = odd;
+            vector<TYPE> block(values);
+            assert(!Network::sort(block.data(), size));
+            assert(equal(block.begin(), block.end(), values.begin(), ZeroTag()));
+        }
+    }
+
+    // mergeSort keeps equal zeros of either sign in their order
+    vector<TYPE> zeros;
+    for(int i = 0; i < 300; ++i){
+        int pick = rand() % 4;
+        zeros.push_back(pick == 0 ? -TYPE(0) : pick == 1 ? TYPE(0) : networkValue<TYPE>());
+    }
+    vector<TYPE> expect(zeros);
+    std::stable_sort(expect.begin(), expect.end(), COMP());
+    mergeSort(zeros.begin(), zeros.end(), COMP());
+    assert(equal(zeros.begin(), zeros.end(), expect.begin(), ZeroTag()));
+}
+
+void testSortingNetwork(){
+    testNetworkType<int32_t, std::less<int32_t>>();
+    testNetworkType<int32_t, std::greater<int32_t>>();
+    testNetworkType<int64_t, std::less<int64_t>>();
+    testNetworkType<int64_t, std::greater<int64_t>>();
+    testNetworkType<float, std::less<float>>();
+    testNetworkType<float, std::greater<float>>();
+    testNetworkType<double, std::less<double>>();
+    testNetworkType<double, std::greater<double>>();
+    testNetworkRefuses<float, std::less<float>>();
+    testNetworkRefuses<float, std::greater<float>>();
+    testNetworkRefuses<double, std::less<double>>();
+    testNetworkRefuses<double, std::greater<double>>();
+}
+
+struct Record {
+    int key;
+    int seq;
+};
+
+struct RecordKeyComp {
+    bool operator()(const Record& a, const Record& b) const {
+        return a.key < b.key;
+    }
+};
+
+const char* const SORT_INPUT = "testSort.in.tmp";
+const char* const SORT_OUTPUT = "testSort.out.tmp";
+
+void writeFile(const char* path, const string& bytes){
+    FILE* file = fopen(path, "wb");
+    assert(file != nullptr);
+    assert(fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size());
+    fclose(file);
+}
+
+string readFile(const char* path){
+    FILE* file = fopen(path, "rb");
+    assert(file != nullptr);
+    string bytes;
+    char block[4096];
+    for(size_t count; (count = fread(block, 1, sizeof(block), file)) > 0;) bytes.append(block, count);
+    fclose(file);
+    return bytes;
+}
+
+void testExternalSort(){
+    // a few KB of memory makes runs of about 200 records and a fan-in of 2,
+    // so the runs are carried through several levels and the last ones
+    // regrouped before the final merge
+    vector<Record> records;
+    for(int i = 0; i < 5000; ++i) records.push_back(Record{ rand() % 50, i });
+    writeFile(SORT_INPUT, string(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record)));
+    externalSort<RecordFormat<Record>>(SORT_INPUT, SORT_OUTPUT, RecordKeyComp(), 4096);
+    std::stable_sort(records.begin(), records.end(), RecordKeyComp());
+    string sorted = readFile(SORT_OUTPUT);
+    assert(sorted.size() == records.size() * sizeof(Record));
+    for(size_t i = 0; i < records.size(); ++i){
+        Record record;
+        memcpy(&record, sorted.data() + i * sizeof(Record), sizeof(Record));
+        assert(record.key == records[i].key && record.seq == records[i].seq);
+    }
+
+    // a file that ends inside a record
+    writeFile(SORT_INPUT, string(3 * sizeof(Record) + 1, 'x'));
+    bool threw = false;
+    try{
+        externalSort<RecordFormat<Record>>(SORT_INPUT, SORT_OUTPUT, RecordKeyComp(), 4096);
+    }
+    catch(const runtime_error&){
+        threw = true;
+    }
+    assert(threw);
+
+    // lines, with and without a '\n' after the last one, in one chunk and
+    // through many runs
+    writeFile(SORT_INPUT, "b\na\nc");
+    externalSort<LineFormat>(SORT_INPUT, SORT_OUTPUT, std::less<string>());
+    assert(readFile(SORT_OUTPUT) == "a\nb\nc\n");
+    vector<string> lines;
+    string text;
+    for(int i = 0; i < 3000; ++i){
+        lines.push_back(string(static_cast<size_t>(rand() % 20), static_cast<char>('a' + rand() % 3)));
+        text += lines.back() + "\n";
+    }
+    std::sort(lines.begin(), lines.end());
+    string expect;
+    for(const string& line : lines) expect += line + "\n";
+    for(size_t cut : { size_t(0), size_t(1) }){
+        writeFile(SORT_INPUT, text.substr(0, text.size() - cut));
+        externalSort<LineFormat>(SORT_INPUT, SORT_OUTPUT, std::less<string>(), 4096);
+        assert(readFile(SORT_OUTPUT) == expect);
+    }
+
+    // an empty file stays empty
+    writeFile(SORT_INPUT, "");
+    externalSort<LineFormat>(SORT_INPUT, SORT_OUTPUT, std::less<string>(), 4096);
+    assert(readFile(SORT_OUTPUT).empty());
+    externalSort<RecordFormat<Record>>(SORT_INPUT, SORT_OUTPUT, RecordKeyComp(), 4096);
+    assert(readFile(SORT_OUTPUT).empty());
+
+    remove(SORT_INPUT);
+    remove(SORT_OUTPUT);
+}
+
+// std::less without a SortingNetwork, so the sorts take their plain paths
+struct IntLess {
+    bool operator()(int a, int b) const {
+        return a < b;
+    }
+};
+
+// EFFECT: return size elements in one of the patterns that break naive
+//         quicksorts: sorted, reversed, organ pipe, all equal, few keys
+vector<int> sortPattern(int pattern, int size){
+    vector<int> values;
+    for(int i = 0; i < size; ++i){
+        switch(pattern){
+        case 0: values.push_back(i); break;
+        case 1: values.push_back(size - i); break;
+        case 2: values.push_back(min(i, size - i)); break;
+        case 3: values.push_back(7); break;
+        default: values.push_back(rand() % 4); break;
+        }
+    }
+    return values;
+}
+
+// McIlroy's adversary for quicksort: the values of the elements are decided
+// while they are compared, each pivot candidate is made as small as possible
+struct AntiQuickSort {
+    vector<int>* values;
+    int* solid;
+    int* candidate;
+    size_t* compares;
+
+    bool operator()(int a, int b) const {
+        vector<int>& value = *this->values;
+        int gas = static_cast<int>(value.size());
+        ++*this->compares;
+        if(value[a] == gas && value[b] == gas) value[(a == *this->candidate) ? a : b] = (*this->solid)++;
+        if(value[a] == gas) *this->candidate = a;
+        else if(value[b] == gas) *this->candidate = b;
+        return value[a] < value[b];
+    }
+};
+
+void testQuickSort(){
+    for(int pattern = 0; pattern < 5; ++pattern){
+        for(int size : { 0, 1, 2, 15, 16, 17, 63, 64, 65, 127, 128, 129, 1000 }){
+            vector<int> values = sortPattern(pattern, size);
+            vector<int> expect(values);
+            std::sort(expect.begin(), expect.end());
+            vector<int> network(values);
+            quickSort(network.begin(), network.end(), std::less<int>());
+            assert(network == expect);
+            vector<int> plain(values);
+            quickSort(plain.begin(), plain.end(), IntLess());
+            assert(plain == expect);
+            vector<unique_ptr<int>> pointers;
+            for(int x : values) pointers.emplace_back(new int(x));
+            quickSort(pointers.begin(), pointers.end(), UniquePtrComp());
+            for(int i = 0; i < size; ++i) assert(*pointers[static_cast<size_t>(i)] == expect[static_cast<size_t>(i)]);
+        }
+    }
+
+    // against the adversary every partition is as bad as it can be, only the
+    // switch to heapSort keeps it O(n log(n))
+    const int SIZE = 20000;
+    vector<int> value(SIZE, SIZE);
+    vector<int> order(SIZE);
+    for(int i = 0; i < SIZE; ++i) order[static_cast<size_t>(i)] = i;
+    int solid = 0;
+    int candidate = 0;
+    size_t compares = 0;
+    quickSort(order.begin(), order.end(), AntiQuickSort{ &value, &solid, &candidate, &compares });
+    size_t logSize = 0;
+    for(int n = SIZE; n > 1; n /= 2) logSize++;
+    assert(compares < 6 * SIZE * logSize);
+    for(int i = 1; i < SIZE; ++i){
+        assert(value[static_cast<size_t>(order[static_cast<size_t>(i - 1)])] <= value[static_cast<size_t>(order[static_cast<size_t>(i)])]);
+    }
+}
+
+struct CountingPairKeyComp {
+    size_t* compares;
+
+    bool operator()(const pair<int, int>& a, const pair<int, int>& b) const {
+        ++*this->compares;
+        return a.first < b.first;
+    }
+};
+
+// EFFECT: sort values with mergeSort and check it against std::stable_sort
+void checkMergeSort(vector<pair<int, int>> values){
+    vector<pair<int, int>> expect(values);
+    std::stable_sort(expect.begin(), expect.end(), PairKeyComp());
+    mergeSort(values.begin(), values.end(), PairKeyComp());
+    assert(values == expect);
+}
+
+void testMergeSort(){
+    // random keys with many ties, and runs of 100 elements that are
+    // ascending or strictly descending, so 1 to 9 runs need 0 to 4 passes,
+    // both odd and even counts
+    for(int runs = 1; runs <= 9; ++runs){
+        vector<pair<int, int>> random;
+        vector<pair<int, int>> natural;
+        for(int run = 0; run < runs; ++run){
+            int start = rand() % 1000;
+            for(int i = 0; i < 100; ++i){
+                int seq = static_cast<int>(natural.size());
+                random.push_back(make_pair(rand() % 20, seq));
+                natural.push_back(make_pair((run % 2 == 0) ? start + i / 3 : start - i, seq));
+            }
+        }
+        checkMergeSort(random);
+        checkMergeSort(natural);
+    }
+    // a descending run with equal keys is not strictly descending, it must
+    // not be reversed as a whole
+    vector<pair<int, int>> ties;
+    for(int i = 0; i < 300; ++i) ties.push_back(make_pair(100 - i / 2, i));
+    checkMergeSort(ties);
+    for(int size = 0; size < 100; ++size){
+        vector<pair<int, int>> small;
+        for(int i = 0; i < size; ++i) small.push_back(make_pair(rand() % 5, i));
+        checkMergeSort(small);
+    }
+
+    // two runs that do not overlap: after 7 wins in a row the merge gallops,
+    // so it takes few comparisons beyond the 2n of finding the runs
+    const int SIZE = 10000;
+    vector<pair<int, int>> apart;
+    for(int i = 0; i < SIZE; ++i) apart.push_back(make_pair(SIZE + i, i));
+    for(int i = 0; i < SIZE; ++i) apart.push_back(make_pair(i, SIZE + i));
+    size_t compares = 0;
+    mergeSort(apart.begin(), apart.end(), CountingPairKeyComp{ &compares });
+    assert(compares < 2 * SIZE + 100);
+    for(int i = 0; i < 2 * SIZE; ++i) assert(apart[static_cast<size_t>(i)].first == i);
+
+    // move-only elements
+    vector<unique_ptr<int>> pointers;
+    vector<int> expect;
+    for(int i = 0; i < 1000; ++i){
+        expect.push_back(rand() % 100);
+        pointers.emplace_back(new int(expect.back()));
+    }
+    std::sort(expect.begin(), expect.end());
+    mergeSort(pointers.begin(), pointers.end(), UniquePtrComp());
+    for(size_t i = 0; i < expect.size(); ++i) assert(*pointers[i] == expect[i]);
+}
+
+int main(){
+    testQuickSort();
+    testMergeSort();
+    testSortingNetwork();
+    testExternalSort();
+    testStringRadixSort();
+    for(size_t threads : { 1, 2, 4, 7 }){
+        testWorkStealingPool(threads);
+        testParallelSorts(threads);
+    }
+}